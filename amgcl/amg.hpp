@@ -34,9 +34,15 @@ THE SOFTWARE.
 #include <iostream>
 #include <iomanip>
 #include <list>
+#include <vector>
+#include <array>
 #include <memory>
+#include <type_traits>
 
 #include <amgcl/backend/builtin.hpp>
+#include <amgcl/coarsening/detail/galerkin.hpp>
+#include <amgcl/detail/serial_region.hpp>
+#include <amgcl/io/hierarchy.hpp>
 #include <amgcl/solver/detail/default_inner_product.hpp>
 #include <amgcl/util.hpp>
 
@@ -129,11 +135,49 @@ class amg {
             /// Number of cycles to make as part of preconditioning.
             unsigned pre_cycles;
 
+            /// Keep transfer operators to allow rebuilding the hierarchy.
+            /**
+             * When set, the prolongation and restriction operators are
+             * stored in the builtin format after the setup, so that
+             * rebuild() is able to update the hierarchy for a new matrix
+             * with the same sparsity pattern without redoing the
+             * coarsening.
+             */
+            bool allow_rebuild;
+
+            /// Number of levels stored in the precision of the backend.
+            /**
+             * The rest of the hierarchy (the system and transfer operators,
+             * the smoothers, and the coarse solver) is stored in single
+             * precision, see amgcl::backend::single_precision. The hierarchy
+             * is still constructed in the full precision. The coarse levels
+             * do not need the full accuracy of the preconditioner, and halving
+             * their memory footprint speeds up the memory-bound solution
+             * phase. Should be positive, so that the system matrix is kept
+             * intact. All levels use the full precision by default.
+             */
+            unsigned full_precision_levels;
+
+            /// Levels with fewer unknowns are processed by a single thread.
+            /**
+             * On the coarse levels the cost of starting and synchronizing the
+             * OpenMP thread team for each of the operations in the cycle
+             * exceeds the work itself. When the cycle reaches a level with
+             * less than the given number of unknowns, the level and the ones
+             * below it are processed sequentially. The reasonable value
+             * depends on the number of threads, but a few thousand unknowns
+             * is a good start. Disabled by default.
+             */
+            size_t serial_coarse_size;
+
             params() :
                 coarse_enough( Backend::direct_solver::coarse_enough() ),
                 direct_coarse(true),
                 max_levels( std::numeric_limits<unsigned>::max() ),
-                npre(1), npost(1), ncycle(1), pre_cycles(1)
+                npre(1), npost(1), ncycle(1), pre_cycles(1),
+                allow_rebuild(false),
+                full_precision_levels( std::numeric_limits<unsigned>::max() ),
+                serial_coarse_size(0)
             {}
 
 #ifndef AMGCL_NO_BOOST
@@ -146,11 +190,15 @@ class amg {
                   AMGCL_PARAMS_IMPORT_VALUE(p, npre),
                   AMGCL_PARAMS_IMPORT_VALUE(p, npost),
                   AMGCL_PARAMS_IMPORT_VALUE(p, ncycle),
-                  AMGCL_PARAMS_IMPORT_VALUE(p, pre_cycles)
+                  AMGCL_PARAMS_IMPORT_VALUE(p, pre_cycles),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, allow_rebuild),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, full_precision_levels),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, serial_coarse_size)
             {
                 check_params(p, {"coarsening", "relax", "coarse_enough",
                         "direct_coarse", "max_levels", "npre", "npost",
-                        "ncycle",  "pre_cycles"});
+                        "ncycle",  "pre_cycles", "allow_rebuild",
+                        "full_precision_levels", "serial_coarse_size"});
 
                 precondition(max_levels > 0, "max_levels should be positive");
             }
@@ -169,6 +217,9 @@ class amg {
                 AMGCL_PARAMS_EXPORT_VALUE(p, path, npost);
                 AMGCL_PARAMS_EXPORT_VALUE(p, path, ncycle);
                 AMGCL_PARAMS_EXPORT_VALUE(p, path, pre_cycles);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, allow_rebuild);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, full_precision_levels);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, serial_coarse_size);
             }
 #endif
         } prm;
@@ -218,6 +269,62 @@ class amg {
             do_init(A, bprm);
         }
 
+        /// Loads the AMG hierarchy saved with save().
+        /**
+         * The matrices of the hierarchy are memory mapped from the file, and
+         * are used in place by the builtin backend, unless the memory arena
+         * or the NUMA mode are enabled in the backend parameters. The
+         * smoothers and the coarse level solver are set up on load. The
+         * hierarchy structure comes from the file, so the coarsening
+         * parameters are ignored, and the hierarchy can not be rebuilt.
+         */
+        amg(
+                const io::hierarchy &H,
+                const params &p = params(),
+                const backend_params &bprm = backend_params()
+           ) : prm(p)
+        {
+            do_load(H, bprm);
+        }
+
+        /// Rebuilds the AMG hierarchy for the new system matrix.
+        /**
+         * The new matrix should have the same size as the one used during
+         * the construction, and should have the same sparsity
+         * pattern. The coarsening is not repeated: the transfer operators
+         * stored during the initial setup are reused, and only the coarse
+         * operators, the smoothers, and the coarse level solver are
+         * recomputed. The sparsity patterns of the coarse operators are
+         * reused as well, so only the numeric part of the Galerkin products
+         * is computed. Requires prm.allow_rebuild to be set.
+         *
+         * \param A The new system matrix. Should be convertible to
+         *          amgcl::backend::crs<>.
+         */
+        template <class Matrix>
+        void rebuild(
+                const Matrix &M,
+                const backend_params &bprm = backend_params()
+                )
+        {
+            auto A = std::make_shared<build_matrix>(M);
+            sort_rows(*A);
+
+            do_rebuild(A, bprm);
+        }
+
+        /// Rebuilds the AMG hierarchy for the new system matrix.
+        /**
+         * The matrix will not be copied and should out-live the amg instance.
+         */
+        void rebuild(
+                std::shared_ptr<build_matrix> A,
+                const backend_params &bprm = backend_params()
+                )
+        {
+            do_rebuild(A, bprm);
+        }
+
         /// Performs single V-cycle for the given right-hand side and solution.
         /**
          * \param rhs Right-hand side vector.
@@ -225,7 +332,7 @@ class amg {
          */
         template <class Vec1, class Vec2>
         void cycle(const Vec1 &rhs, Vec2 &&x) const {
-            cycle(levels.begin(), rhs, x);
+            cycles(1, rhs, x);
         }
 
         /// Performs single V-cycle after clearing x.
@@ -239,8 +346,7 @@ class amg {
         void apply(const Vec1 &rhs, Vec2 &&x) const {
             if (prm.pre_cycles) {
                 backend::clear(x);
-                for(unsigned i = 0; i < prm.pre_cycles; ++i)
-                    cycle(rhs, x);
+                cycles(prm.pre_cycles, rhs, x);
             } else {
                 backend::copy(rhs, x);
             }
@@ -257,35 +363,71 @@ class amg {
 
         size_t bytes() const {
             size_t b = 0;
-            for(const auto &lvl : levels) b += lvl.bytes();
+            for(const auto &lvl : levels)    b += lvl.bytes();
+            for(const auto &lvl : lp_levels) b += lvl.bytes();
             return b;
         }
+
+        /// Saves the hierarchy to a file.
+        /**
+         * The system and transfer operators of each level are stored, see
+         * amgcl::io::hierarchy for the format. Only supported for the
+         * backends that keep the matrices in the CRS format (builtin).
+         */
+        void save(const std::string &fname) const {
+            io::hierarchy::writer w(fname, levels.size() + lp_levels.size(),
+                    sizeof(value_type), sizeof(typename lp_backend::value_type));
+
+            for(const auto &lvl : levels)    save_level(w, lvl, 0);
+            for(const auto &lvl : lp_levels) save_level(w, lvl, io::hierarchy::single_precision);
+        }
     private:
-        struct level {
+        typedef typename backend::single_precision<Backend>::type lp_backend;
+        typedef typename lp_backend::vector lp_vector;
+
+        template <class B>
+        struct basic_level {
+            typedef typename B::matrix        level_matrix;
+            typedef Relax<B>                  level_relax;
+            typedef typename level_relax::params relax_params;
+            typedef typename B::params        level_params;
+
+            // Matrix in the builtin format with the value type of the level.
+            typedef typename backend::builtin<typename B::value_type>::matrix host_matrix;
+
             size_t m_rows, m_nonzeros;
 
-            std::shared_ptr<vector> f;
-            std::shared_ptr<vector> u;
-            std::shared_ptr<vector> t;
+            // Work vectors: f (rhs), u (solution), and t (temporary, absent
+            // on the coarsest level with a direct solver).
+            backend::work_vectors<B> work;
 
-            std::shared_ptr<matrix> A;
-            std::shared_ptr<matrix> P;
-            std::shared_ptr<matrix> R;
+            std::shared_ptr<level_matrix> A;
+            std::shared_ptr<level_matrix> P;
+            std::shared_ptr<level_matrix> R;
 
-            std::shared_ptr< typename Backend::direct_solver > solve;
+            // Data for the fused residual and restriction.
+            std::shared_ptr<typename backend::restriction_plan<B>::type> rplan;
 
-            std::shared_ptr<relax_type> relax;
+            // Transfer operators in the builtin format (kept for rebuild).
+            std::shared_ptr<build_matrix> bP;
+            std::shared_ptr<build_matrix> bR;
+
+            // Structure of the coarse operator (kept for rebuild).
+            coarsening::detail::galerkin_plan<build_matrix> rap;
+
+            std::shared_ptr< typename B::direct_solver > solve;
+
+            std::shared_ptr<level_relax> relax;
 
             size_t bytes() const {
                 size_t b = 0;
 
-                if (f) b += backend::bytes(*f);
-                if (u) b += backend::bytes(*u);
-                if (t) b += backend::bytes(*t);
+                b += backend::bytes(work);
 
                 if (A) b += backend::bytes(*A);
                 if (P) b += backend::bytes(*P);
                 if (R) b += backend::bytes(*R);
+                if (rplan) b += backend::bytes(*rplan);
 
                 if (solve) b += backend::bytes(*solve);
                 if (relax) b += backend::bytes(*relax);
@@ -293,27 +435,28 @@ class amg {
                 return b;
             }
 
-            level() {}
+            basic_level() {}
 
-            level(std::shared_ptr<build_matrix> A,
-                    params &prm, const backend_params &bprm)
+            template <class M>
+            basic_level(std::shared_ptr<M> A,
+                    const relax_params &rprm, const level_params &bprm)
                 : m_rows(backend::rows(*A)), m_nonzeros(backend::nonzeros(*A))
             {
+                auto hA = convert(A);
+
                 AMGCL_TIC("move to backend");
-                f = Backend::create_vector(m_rows, bprm);
-                u = Backend::create_vector(m_rows, bprm);
-                t = Backend::create_vector(m_rows, bprm);
-                this->A = Backend::copy_matrix(A, bprm);
+                this->A = B::copy_matrix(hA, bprm);
+                work = backend::work_vectors<B>(3, m_rows, bprm);
                 AMGCL_TOC("move to backend");
 
                 AMGCL_TIC("relaxation");
-                relax = std::make_shared<relax_type>(*A, prm.relax, bprm);
+                relax = std::make_shared<level_relax>(*hA, rprm, bprm);
                 AMGCL_TOC("relaxation");
             }
 
             std::shared_ptr<build_matrix> step_down(
-                    std::shared_ptr<build_matrix> A,
-                    coarsening_type &C, const backend_params &bprm)
+                    std::shared_ptr<build_matrix> A, coarsening_type &C,
+                    const params &prm, const level_params &bprm)
             {
                 AMGCL_TIC("transfer operators");
                 std::shared_ptr<build_matrix> P, R;
@@ -330,31 +473,105 @@ class amg {
                 AMGCL_TOC("transfer operators");
 
                 AMGCL_TIC("move to backend");
-                this->P = Backend::copy_matrix(P, bprm);
-                this->R = Backend::copy_matrix(R, bprm);
+                this->P = B::copy_matrix(convert(P), bprm);
+                this->R = B::copy_matrix(convert(R), bprm);
+                rplan = backend::restriction_plan<B>::create(*this->A, *this->R, bprm);
                 AMGCL_TOC("move to backend");
 
+                if (prm.allow_rebuild) {
+                    bP = P;
+                    bR = R;
+                }
+
                 AMGCL_TIC("coarse operator");
-                A = C.coarse_operator(*A, *P, *R);
+                if (prm.allow_rebuild)
+                    A = C.coarse_operator(*A, *P, *R, rap);
+                else
+                    A = C.coarse_operator(*A, *P, *R);
                 sort_rows(*A);
                 AMGCL_TOC("coarse operator");
 
                 return A;
             }
 
-            void create_coarse(
-                    std::shared_ptr<build_matrix> A,
-                    const backend_params &bprm, bool single_level)
+            // Moves the transfer operators loaded from a file to the backend.
+            void set_transfer(
+                    std::shared_ptr<host_matrix> P, std::shared_ptr<host_matrix> R,
+                    const level_params &bprm)
+            {
+                this->P = B::copy_matrix(P, bprm);
+                this->R = B::copy_matrix(R, bprm);
+                rplan = backend::restriction_plan<B>::create(*this->A, *this->R, bprm);
+            }
+
+            template <class M>
+            void create_coarse(std::shared_ptr<M> A, const level_params &bprm,
+                    bool single_level)
             {
                 m_rows     = backend::rows(*A);
                 m_nonzeros = backend::nonzeros(*A);
 
-                u = Backend::create_vector(m_rows, bprm);
-                f = Backend::create_vector(m_rows, bprm);
+                work = backend::work_vectors<B>(2, m_rows, bprm);
 
-                solve = Backend::create_solver(A, bprm);
+                auto hA = convert(A);
+
+                solve = B::create_solver(hA, bprm);
+
+                // The system matrix of a single level hierarchy is returned
+                // by system_matrix().
                 if (single_level)
-                    this->A = Backend::copy_matrix(A, bprm);
+                    this->A = B::copy_matrix(hA, bprm);
+                else
+                    keep_coarse_matrix(hA, std::is_same<level_matrix, host_matrix>());
+            }
+
+            // Otherwise, the system matrix of the coarsest level is only
+            // needed by save(), which only works with the builtin matrices.
+            // It is kept as is, without a copy, and only for such backends.
+            void keep_coarse_matrix(std::shared_ptr<host_matrix> hA, std::true_type) {
+                this->A = hA;
+            }
+
+            void keep_coarse_matrix(std::shared_ptr<host_matrix>, std::false_type) {}
+
+            std::shared_ptr<build_matrix> rebuild(
+                    std::shared_ptr<build_matrix> A, const coarsening_type &C,
+                    const relax_params &rprm, const level_params &bprm)
+            {
+                precondition(backend::rows(*A) == m_rows,
+                        "Matrix size has changed since the initial setup");
+
+                m_nonzeros = backend::nonzeros(*A);
+
+                std::shared_ptr<host_matrix> hA;
+                if (this->A || relax || solve) hA = convert(A);
+
+                if (this->A) {
+                    AMGCL_TIC("move to backend");
+                    this->A = B::copy_matrix(hA, bprm);
+                    AMGCL_TOC("move to backend");
+                }
+
+                if (relax) {
+                    AMGCL_TIC("relaxation");
+                    relax = std::make_shared<level_relax>(*hA, rprm, bprm);
+                    AMGCL_TOC("relaxation");
+                }
+
+                if (solve) {
+                    AMGCL_TIC("coarsest level");
+                    solve = B::create_solver(hA, bprm);
+                    AMGCL_TOC("coarsest level");
+                }
+
+                if (!bP || !bR) return std::shared_ptr<build_matrix>();
+
+                AMGCL_TIC("coarse operator");
+                A = C.coarse_operator(*A, *bP, *bR, rap);
+                sort_rows(*A);
+                AMGCL_TOC("coarse operator");
+
+                return A;
             }
 
             size_t rows() const {
@@ -364,11 +581,44 @@ class amg {
             size_t nonzeros() const {
                 return m_nonzeros;
             }
+
+            // The hierarchy is built with the value type of the amg
+            // backend, and is converted when the level uses lower precision.
+            static std::shared_ptr<host_matrix> convert(std::shared_ptr<host_matrix> A) {
+                return A;
+            }
+
+            template <class M>
+            static std::shared_ptr<host_matrix> convert(std::shared_ptr<M> A) {
+                return std::make_shared<host_matrix>(*A);
+            }
         };
 
-        typedef typename std::list<level>::const_iterator level_iterator;
+        typedef basic_level<Backend>    level;
+        typedef basic_level<lp_backend> lp_level;
+
+        typedef typename std::list<level>::const_iterator    level_iterator;
+        typedef typename std::list<lp_level>::const_iterator lp_level_iterator;
+
+        typedef typename backend::work_vectors<Backend>::vector_set    vector_set;
+        typedef typename backend::work_vectors<lp_backend>::vector_set lp_vector_set;
 
-        std::list<level> levels;
+        typedef typename std::vector<vector_set>::const_iterator    work_iterator;
+        typedef typename std::vector<lp_vector_set>::const_iterator lp_work_iterator;
+
+        std::list<level>    levels;
+        std::list<lp_level> lp_levels;
+
+        // Work vectors of the levels. When the backend parameters provide a
+        // workspace, the vectors are borrowed from it on each application
+        // instead.
+        bool                       borrow_work;
+        std::vector<vector_set>    work;
+        std::vector<lp_vector_set> lp_work;
+
+        typename lp_level::relax_params lp_relax;
+
+        std::shared_ptr<coarsening_type> C;
 
         void do_init(
                 std::shared_ptr<build_matrix> A,
@@ -380,16 +630,30 @@ class amg {
                     "Matrix should be square!"
                     );
 
+            precondition(prm.full_precision_levels > 0,
+                    "full_precision_levels should be positive");
+
+            convert_params(prm.relax, lp_relax);
+
             bool direct_coarse_solve = true;
 
-            coarsening_type C(prm.coarsening);
+            C = std::make_shared<coarsening_type>(prm.coarsening);
 
             while( backend::rows(*A) > prm.coarse_enough) {
-                levels.push_back( level(A, prm, bprm) );
+                bool full = levels.size() < prm.full_precision_levels;
+
+                if (full)
+                    levels.push_back( level(A, prm.relax, bprm) );
+                else
+                    lp_levels.push_back( lp_level(A, lp_relax, bprm) );
+
+                if (levels.size() + lp_levels.size() >= prm.max_levels) break;
 
-                if (levels.size() >= prm.max_levels) break;
+                if (full)
+                    A = levels.back().step_down(A, *C, prm, bprm);
+                else
+                    A = lp_levels.back().step_down(A, *C, prm, bprm);
 
-                A = levels.back().step_down(A, C, bprm);
                 if (!A) {
                     // Zero-sized coarse level. Probably the system matrix on
                     // this level is diagonal, should be easily solvable with a
@@ -406,55 +670,263 @@ class amg {
 
             if (direct_coarse_solve) {
                 AMGCL_TIC("coarsest level");
-                if (prm.direct_coarse) {
-                    level l;
-                    l.create_coarse(A, bprm, levels.empty());
-                    levels.push_back(l);
-                } else {
-                    levels.push_back( level(A, prm, bprm) );
-                }
+                if (levels.size() < prm.full_precision_levels)
+                    add_coarse(levels, A, prm.relax, bprm);
+                else
+                    add_coarse(lp_levels, A, lp_relax, bprm);
                 AMGCL_TOC("coarsest level");
             }
+
+            init_work(bprm);
+        }
+
+        template <class Level>
+        void add_coarse(std::list<Level> &list,
+                std::shared_ptr<build_matrix> A,
+                const typename Level::relax_params &rprm,
+                const backend_params &bprm)
+        {
+            if (prm.direct_coarse) {
+                Level l;
+                l.create_coarse(A, bprm, levels.empty() && lp_levels.empty());
+                list.push_back(l);
+            } else {
+                list.push_back( Level(A, rprm, bprm) );
+            }
+        }
+
+        void do_load(const io::hierarchy &H, const backend_params &bprm) {
+            precondition(!(H.flags(0) & io::hierarchy::single_precision),
+                    "The finest level should be in full precision");
+
+            convert_params(prm.relax, lp_relax);
+
+            for(size_t i = 0; i < H.levels(); ++i) {
+                if (H.flags(i) & io::hierarchy::single_precision)
+                    load_level(lp_levels, H, i, lp_relax, bprm);
+                else
+                    load_level(levels, H, i, prm.relax, bprm);
+            }
+
+            init_work(bprm);
+        }
+
+        void init_work(const backend_params &bprm) {
+            borrow_work = static_cast<bool>(backend::detail::params_workspace(bprm, 0));
+            if (borrow_work) return;
+
+            for(const auto &lvl : levels)    work.push_back(lvl.work.get());
+            for(const auto &lvl : lp_levels) lp_work.push_back(lvl.work.get());
+        }
+
+        void get_work(std::vector<vector_set> &w, std::vector<lp_vector_set> &lw) const {
+            w.reserve(levels.size());
+            for(const auto &lvl : levels) w.push_back(lvl.work.get());
+
+            lw.reserve(lp_levels.size());
+            for(const auto &lvl : lp_levels) lw.push_back(lvl.work.get());
         }
 
+        // Performs k V-cycles. The borrowed work vectors are shared by all
+        // of the cycles.
         template <class Vec1, class Vec2>
-        void cycle(level_iterator lvl, const Vec1 &rhs, Vec2 &x) const
+        void cycles(unsigned k, const Vec1 &rhs, Vec2 &x) const {
+            if (!borrow_work) {
+                for(unsigned i = 0; i < k; ++i)
+                    cycle(levels.begin(), work.begin(), lp_work.begin(), rhs, x);
+                return;
+            }
+
+            std::vector<vector_set>    w;
+            std::vector<lp_vector_set> lw;
+            get_work(w, lw);
+
+            for(unsigned i = 0; i < k; ++i)
+                cycle(levels.begin(), w.begin(), lw.begin(), rhs, x);
+        }
+
+        template <class Level>
+        static void load_level(std::list<Level> &list,
+                const io::hierarchy &H, size_t i,
+                const typename Level::relax_params &rprm,
+                const backend_params &bprm)
         {
-            level_iterator nxt = lvl, end = levels.end();
+            typedef typename Level::host_matrix::value_type V;
+
+            const unsigned flags = H.flags(i);
+
+            if (flags & io::hierarchy::direct) {
+                Level l;
+                l.create_coarse(H.A<V>(i), bprm, H.levels() == 1);
+                list.push_back(l);
+            } else {
+                list.push_back( Level(H.A<V>(i), rprm, bprm) );
+
+                if (flags & io::hierarchy::transfer)
+                    list.back().set_transfer(H.P<V>(i), H.R<V>(i), bprm);
+            }
+        }
+
+        template <class Level>
+        static void save_level(io::hierarchy::writer &w, const Level &lvl, unsigned flags) {
+            if (lvl.P)     flags |= io::hierarchy::transfer;
+            if (lvl.solve) flags |= io::hierarchy::direct;
+
+            w.level(flags);
+            w.matrix(*lvl.A);
+
+            if (lvl.P) {
+                w.matrix(*lvl.P);
+                w.matrix(*lvl.R);
+            }
+        }
+
+        void do_rebuild(
+                std::shared_ptr<build_matrix> A,
+                const backend_params &bprm = backend_params()
+                )
+        {
+            precondition(prm.allow_rebuild, "allow_rebuild is not set!");
+            precondition(C, "Hierarchy loaded from a file can not be rebuilt");
+            precondition(
+                    backend::rows(*A) == backend::cols(*A),
+                    "Matrix should be square!"
+                    );
+
+            for(auto &lvl : levels) {
+                if (!A) break;
+                A = lvl.rebuild(A, *C, prm.relax, bprm);
+            }
+
+            for(auto &lvl : lp_levels) {
+                if (!A) break;
+                A = lvl.rebuild(A, *C, lp_relax, bprm);
+            }
+        }
+
+        template <class P>
+        static void convert_params(const P &src, P &dst) {
+            dst = src;
+        }
+
+        // Relaxation parameters for the lower precision levels have a
+        // different type, but the same contents. The builtin relaxations
+        // provide the conversion; the others are converted through a
+        // property tree.
+        template <class P1, class P2>
+        static void convert_params(const P1 &src, P2 &dst) {
+            convert_params(src, dst, std::is_constructible<P2, const P1&>());
+        }
+
+        template <class P1, class P2>
+        static void convert_params(const P1 &src, P2 &dst, std::true_type) {
+            dst = P2(src);
+        }
+
+        template <class P1, class P2>
+        static void convert_params(const P1 &src, P2 &dst, std::false_type) {
+#ifndef AMGCL_NO_BOOST
+            boost::property_tree::ptree p;
+            src.get(p, "");
+            dst = P2(p);
+#else
+            static_assert(std::is_constructible<P2, const P1&>::value,
+                    "The relaxation parameters can not be converted to the lower precision");
+#endif
+        }
+
+        template <class Vec1, class Vec2>
+        void cycle(level_iterator lvl, work_iterator w, lp_work_iterator lw,
+                const Vec1 &rhs, Vec2 &x) const
+        {
+            amgcl::detail::serial_region serial(lvl->rows() < prm.serial_coarse_size);
+
+            level_iterator nxt = lvl;
+            work_iterator  wn  = w;
             ++nxt;
+            ++wn;
+
+            if (nxt != levels.end()) {
+                descend(*lvl, *w, *wn, rhs, x,
+                        [&](const vector &f, vector &u) {
+                            cycle(nxt, wn, lw, f, u);
+                        });
+            } else if (!lp_levels.empty()) {
+                descend(*lvl, *w, *lw, rhs, x,
+                        [&](const lp_vector &f, lp_vector &u) {
+                            lp_cycle(lp_levels.begin(), lw, f, u);
+                        });
+            } else {
+                coarsest(*lvl, *w, rhs, x);
+            }
+        }
 
-            if (nxt == end) {
-                if (lvl->solve) {
-                    AMGCL_TIC("coarse");
-                    (*lvl->solve)(rhs, x);
-                    AMGCL_TOC("coarse");
-                } else {
-                    AMGCL_TIC("relax");
-                    for(size_t i = 0; i < prm.npre;  ++i) lvl->relax->apply_pre(*lvl->A, rhs, x, *lvl->t);
-                    for(size_t i = 0; i < prm.npost; ++i) lvl->relax->apply_post(*lvl->A, rhs, x, *lvl->t);
-                    AMGCL_TOC("relax");
-                }
+        template <class Vec1, class Vec2>
+        void lp_cycle(lp_level_iterator lvl, lp_work_iterator w,
+                const Vec1 &rhs, Vec2 &x) const
+        {
+            amgcl::detail::serial_region serial(lvl->rows() < prm.serial_coarse_size);
+
+            lp_level_iterator nxt = lvl;
+            lp_work_iterator  wn  = w;
+            ++nxt;
+            ++wn;
+
+            if (nxt != lp_levels.end()) {
+                descend(*lvl, *w, *wn, rhs, x,
+                        [&](const lp_vector &f, lp_vector &u) {
+                            lp_cycle(nxt, wn, f, u);
+                        });
             } else {
-                for (size_t j = 0; j < prm.ncycle; ++j) {
-                    AMGCL_TIC("relax");
-                    for(size_t i = 0; i < prm.npre; ++i)
-                        lvl->relax->apply_pre(*lvl->A, rhs, x, *lvl->t);
-                    AMGCL_TOC("relax");
+                coarsest(*lvl, *w, rhs, x);
+            }
+        }
 
-                    backend::residual(rhs, *lvl->A, x, *lvl->t);
+        // Smoothing and coarse grid correction on a level. The coarse grid
+        // problem is solved by cycle_coarse(f, u), where f and u are the
+        // work vectors of the next level.
+        template <class Level, class Work, class NextWork, class Vec1, class Vec2, class Coarse>
+        void descend(const Level &lvl, const Work &w, const NextWork &wn,
+                const Vec1 &rhs, Vec2 &x, Coarse &&cycle_coarse) const
+        {
+            auto &t = *w[2];
+            auto &f = *wn[0];
+            auto &u = *wn[1];
 
-                    backend::spmv(math::identity<scalar_type>(), *lvl->R, *lvl->t, math::zero<scalar_type>(), *nxt->f);
+            for (size_t j = 0; j < prm.ncycle; ++j) {
+                AMGCL_TIC("relax");
+                for(size_t i = 0; i < prm.npre; ++i)
+                    lvl.relax->apply_pre(*lvl.A, rhs, x, t);
+                AMGCL_TOC("relax");
 
-                    backend::clear(*nxt->u);
-                    cycle(nxt, *nxt->f, *nxt->u);
+                backend::residual_restrict(rhs, *lvl.A, x, *lvl.R, lvl.rplan.get(), t, f);
 
-                    backend::spmv(math::identity<scalar_type>(), *lvl->P, *nxt->u, math::identity<scalar_type>(), x);
+                backend::clear(u);
+                cycle_coarse(f, u);
 
-                    AMGCL_TIC("relax");
-                    for(size_t i = 0; i < prm.npost; ++i)
-                        lvl->relax->apply_post(*lvl->A, rhs, x, *lvl->t);
-                    AMGCL_TOC("relax");
-                }
+                backend::spmv(math::identity<scalar_type>(), *lvl.P, u, math::identity<scalar_type>(), x);
+
+                AMGCL_TIC("relax");
+                for(size_t i = 0; i < prm.npost; ++i)
+                    lvl.relax->apply_post(*lvl.A, rhs, x, t);
+                AMGCL_TOC("relax");
+            }
+        }
+
+        template <class Level, class Work, class Vec1, class Vec2>
+        void coarsest(const Level &lvl, const Work &w, const Vec1 &rhs, Vec2 &x) const
+        {
+            if (lvl.solve) {
+                AMGCL_TIC("coarse");
+                (*lvl.solve)(rhs, x);
+                AMGCL_TOC("coarse");
+            } else {
+                auto &t = *w[2];
+
+                AMGCL_TIC("relax");
+                for(size_t i = 0; i < prm.npre;  ++i) lvl.relax->apply_pre(*lvl.A, rhs, x, t);
+                for(size_t i = 0; i < prm.npost; ++i) lvl.relax->apply_post(*lvl.A, rhs, x, t);
+                AMGCL_TOC("relax");
             }
         }
 
@@ -466,38 +938,50 @@ class amg {
 template <class B, template <class> class C, template <class> class R>
 std::ostream& operator<<(std::ostream &os, const amg<B, C, R> &a)
 {
-    typedef typename amg<B, C, R>::level level;
     std::ios_base::fmtflags ff(os.flags());
     auto fp = os.precision();
 
+    // Rows, nonzeros, and memory footprint of each level.
+    std::vector< std::array<size_t, 3> > info;
+
+    for(const auto &lvl : a.levels)
+        info.push_back({{lvl.rows(), lvl.nonzeros(), lvl.bytes()}});
+
+    for(const auto &lvl : a.lp_levels)
+        info.push_back({{lvl.rows(), lvl.nonzeros(), lvl.bytes()}});
+
     size_t sum_dof = 0;
     size_t sum_nnz = 0;
     size_t sum_mem = 0;
 
-    for(const level &lvl : a.levels) {
-        sum_dof += lvl.rows();
-        sum_nnz += lvl.nonzeros();
-        sum_mem += lvl.bytes();
+    for(const auto &lvl : info) {
+        sum_dof += lvl[0];
+        sum_nnz += lvl[1];
+        sum_mem += lvl[2];
     }
 
-    os << "Number of levels:    "   << a.levels.size()
+    os << "Number of levels:    "   << info.size()
         << "\nOperator complexity: " << std::fixed << std::setprecision(2)
-        << 1.0 * sum_nnz / a.levels.front().nonzeros()
+        << 1.0 * sum_nnz / info.front()[1]
         << "\nGrid complexity:     " << std::fixed << std::setprecision(2)
-        << 1.0 * sum_dof / a.levels.front().rows()
-        << "\nMemory footprint:    " << human_readable_memory(sum_mem)
-        << "\n\n"
+        << 1.0 * sum_dof / info.front()[0]
+        << "\nMemory footprint:    " << human_readable_memory(sum_mem);
+
+    if (!a.lp_levels.empty())
+        os << "\nSingle precision:    levels " << a.levels.size() << " and below";
+
+    os << "\n\n"
            "level     unknowns       nonzeros      memory\n"
            "---------------------------------------------\n";
 
     size_t depth = 0;
-    for(const level &lvl : a.levels) {
+    for(const auto &lvl : info) {
         os << std::setw(5)  << depth++
-            << std::setw(13) << lvl.rows()
-            << std::setw(15) << lvl.nonzeros()
-            << std::setw(12) << human_readable_memory(lvl.bytes())
+            << std::setw(13) << lvl[0]
+            << std::setw(15) << lvl[1]
+            << std::setw(12) << human_readable_memory(lvl[2])
             << " (" << std::setw(5) << std::fixed << std::setprecision(2)
-            << 100.0 * lvl.nonzeros() / sum_nnz
+            << 100.0 * lvl[1] / sum_nnz
             << "%)" << std::endl;
     }
 
@@ -0,0 +1,163 @@
+#ifndef AMGCL_BACKEND_ARENA_HPP
+#define AMGCL_BACKEND_ARENA_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/backend/arena.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Memory arena for the builtin backend.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <cstdint>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+namespace amgcl {
+namespace backend {
+
+/// Memory arena.
+/**
+ * Hands out memory from a few large blocks. Individual allocations are never
+ * released; all of the memory is returned at once when the arena is
+ * destroyed. The blocks are aligned to the huge page boundary, and on Linux
+ * the kernel is advised to back them with transparent huge pages.
+ *
+ * The arena is shared (by std::shared_ptr) between all of the objects
+ * allocated in it, so it stays alive as long as any of them does.
+ */
+class arena {
+    public:
+        /// Alignment of the blocks (the size of a huge page on x86_64).
+        static const size_t block_alignment = 2 * 1024 * 1024;
+
+        /// Alignment of individual allocations (a cache line).
+        static const size_t alignment = 64;
+
+        /// Creates the arena.
+        /**
+         * \param block_size Minimum size of a block. Allocations larger than
+         *                   this get a block of their own.
+         */
+        arena(size_t block_size = 64 * 1024 * 1024)
+            : block_size(round_up(block_size, block_alignment)),
+              head(0), tail(0), reserved(0), used(0)
+        {}
+
+        ~arena() {
+            for(char *b : blocks) delete[] b;
+        }
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        /// Returns uninitialized memory for n bytes.
+        void* allocate(size_t n) {
+            n = round_up(n ? n : 1, alignment);
+
+            std::lock_guard<std::mutex> lock(mx);
+
+            if (static_cast<size_t>(tail - head) < n) new_block(n);
+
+            char *p = head;
+            head += n;
+            used += n;
+
+            return p;
+        }
+
+        /// Returns array of n value-initialized elements.
+        /**
+         * Elements are never destroyed, so the type has to be trivially
+         * destructible. The elements are initialized in parallel (zeroed for
+         * the arithmetic types), so that the memory pages are first touched
+         * by the threads that will work with them.
+         */
+        template <class T>
+        T* allocate_array(size_t n) {
+            static_assert(std::is_trivially_destructible<T>::value,
+                    "Arena may only hold trivially destructible types");
+
+            T *p = static_cast<T*>(allocate(n * sizeof(T)));
+
+#pragma omp parallel for
+            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i)
+                new(p + i) T();
+
+            return p;
+        }
+
+        /// Total size of the allocated blocks.
+        size_t bytes() const {
+            return reserved;
+        }
+
+        /// Number of bytes handed out by the arena.
+        size_t used_bytes() const {
+            return used;
+        }
+    private:
+        size_t block_size;
+
+        std::mutex mx;
+        std::vector<char*> blocks;
+
+        char *head, *tail;
+        size_t reserved, used;
+
+        static size_t round_up(size_t n, size_t a) {
+            return (n + a - 1) / a * a;
+        }
+
+        void new_block(size_t n) {
+            size_t size = std::max(block_size, round_up(n, block_alignment));
+
+            char *b = new char[size + block_alignment];
+            blocks.push_back(b);
+
+            head = reinterpret_cast<char*>(
+                    round_up(reinterpret_cast<std::uintptr_t>(b), block_alignment));
+            tail = head + size;
+
+            reserved += size;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+            madvise(head, size, MADV_HUGEPAGE);
+#endif
+        }
+};
+
+} // namespace backend
+} // namespace amgcl
+
+#endif
@@ -43,6 +43,9 @@ THE SOFTWARE.
 
 #include <amgcl/util.hpp>
 #include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/arena.hpp>
+#include <amgcl/backend/workspace.hpp>
+#include <amgcl/backend/numa_layout.hpp>
 #include <amgcl/solver/skyline_lu.hpp>
 #include <amgcl/detail/inverse.hpp>
 #include <amgcl/detail/sort_row.hpp>
@@ -70,6 +73,12 @@ struct crs {
     val_type * val;
     bool own_data;
 
+    // Memory arena holding the matrix data (if any).
+    std::shared_ptr<arena> pool;
+
+    // Thread to row mapping the data was placed with (NUMA mode only).
+    std::shared_ptr<const numa_partition> part;
+
     crs() : nrows(0), ncols(0), nnz(0), ptr(0), col(0), val(0), own_data(true)
     {}
 
@@ -100,9 +109,9 @@ struct crs {
                     std::begin(val_range), std::end(val_range)),
                 "val_range has wrong size in crs constructor");
 
-        ptr = new ptr_type[nrows + 1];
-        col = new col_type[nnz];
-        val = new val_type[nnz];
+        ptr = allocate<ptr_type>(nrows + 1);
+        col = allocate<col_type>(nnz);
+        val = allocate<val_type>(nnz);
 
         ptr[0] = ptr_range[0];
 #pragma omp parallel for
@@ -120,7 +129,7 @@ struct crs {
         nrows(backend::rows(A)), ncols(backend::cols(A)),
         nnz(0), ptr(0), col(0), val(0), own_data(true)
     {
-        ptr = new ptr_type[nrows + 1];
+        ptr = allocate<ptr_type>(nrows + 1);
         ptr[0] = 0;
 
 #pragma omp parallel for
@@ -131,8 +140,8 @@ struct crs {
         }
 
         nnz = scan_row_sizes();
-        col = new col_type[nnz];
-        val = new val_type[nnz];
+        col = allocate<col_type>(nnz);
+        val = allocate<val_type>(nnz);
 
 #pragma omp parallel for
         for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(nrows); ++i) {
@@ -151,9 +160,9 @@ struct crs {
         ptr(0), col(0), val(0), own_data(true)
     {
         if (other.ptr && other.col && other.val) {
-            ptr = new ptr_type[nrows + 1];
-            col = new col_type[nnz];
-            val = new val_type[nnz];
+            ptr = allocate<ptr_type>(nrows + 1);
+            col = allocate<col_type>(nnz);
+            val = allocate<val_type>(nnz);
 
             ptr[0] = other.ptr[0];
 #pragma omp parallel for
@@ -170,7 +179,8 @@ struct crs {
     crs(crs &&other) :
         nrows(other.nrows), ncols(other.ncols), nnz(other.nnz),
         ptr(other.ptr), col(other.col), val(other.val),
-        own_data(other.own_data)
+        own_data(other.own_data), pool(std::move(other.pool)),
+        part(std::move(other.part))
     {
         other.nrows = 0;
         other.ncols = 0;
@@ -188,9 +198,9 @@ struct crs {
         nnz   = other.nnz;
 
         if (other.ptr && other.col && other.val) {
-            ptr = new ptr_type[nrows + 1];
-            col = new col_type[nnz];
-            val = new val_type[nnz];
+            ptr = allocate<ptr_type>(nrows + 1);
+            col = allocate<col_type>(nnz);
+            val = allocate<val_type>(nnz);
 
             ptr[0] = other.ptr[0];
 #pragma omp parallel for
@@ -214,25 +224,38 @@ struct crs {
         std::swap(col,      other.col);
         std::swap(val,      other.val);
         std::swap(own_data, other.own_data);
+        std::swap(pool,     other.pool);
+        std::swap(part,     other.part);
 
         return *this;
     }
 
     void free_data() {
-        if (own_data) {
+        if (pool) {
+            // The memory is released together with the arena.
+            ptr = 0;
+            col = 0;
+            val = 0;
+        } else if (own_data) {
             delete[] ptr; ptr = 0;
             delete[] col; col = 0;
             delete[] val; val = 0;
         }
     }
 
+    // Allocates array either in the memory arena or on the heap.
+    template <class T>
+    T* allocate(size_t n) const {
+        return pool ? pool->template allocate_array<T>(n) : new T[n];
+    }
+
     void set_size(size_t n, size_t m, bool clean_ptr = false) {
         precondition(!ptr, "matrix data has already been allocated!");
 
         nrows = n;
         ncols = m;
 
-        ptr = new ptr_type[nrows + 1];
+        ptr = allocate<ptr_type>(nrows + 1);
 
         if (clean_ptr) {
             ptr[0] = 0;
@@ -266,10 +289,10 @@ struct crs {
 
         nnz = n;
 
-        col = new col_type[nnz];
+        col = allocate<col_type>(nnz);
 
         if (need_values)
-            val = new val_type[nnz];
+            val = allocate<val_type>(nnz);
     }
 
     ~crs() {
@@ -392,6 +415,129 @@ product(const crs<Val,Col,Ptr> &A, const crs<Val,Col,Ptr> &B, bool sort = false)
     return C;
 }
 
+/// Sparsity pattern of a matrix-matrix product.
+/**
+ * Filled by the first call to product(A, B, plan), and reused by the
+ * subsequent calls. Products of matrices having the same sparsity patterns as
+ * the ones used to fill the plan only need to do the numeric pass.
+ */
+template <class Col = ptrdiff_t, class Ptr = Col>
+struct product_plan {
+    size_t nrows, ncols;
+    std::vector<Ptr> ptr;
+    std::vector<Col> col;
+
+    product_plan() : nrows(0), ncols(0) {}
+
+    bool empty() const {
+        return ptr.empty();
+    }
+
+    void clear() {
+        nrows = ncols = 0;
+        std::vector<Ptr>().swap(ptr);
+        std::vector<Col>().swap(col);
+    }
+
+    size_t bytes() const {
+        return sizeof(Ptr) * ptr.size() + sizeof(Col) * col.size();
+    }
+};
+
+/// Matrix-matrix product reusing the product structure.
+/**
+ * When the plan is empty, the full product is computed, and its sparsity
+ * pattern is saved into the plan. Otherwise, only the values of the product
+ * are computed. The rows of the result are sorted by columns.
+ */
+template <class Val, class Col, class Ptr>
+std::shared_ptr< crs<Val, Col, Ptr> >
+product(const crs<Val,Col,Ptr> &A, const crs<Val,Col,Ptr> &B,
+        product_plan<Col, Ptr> &plan)
+{
+    if (plan.empty()) {
+        auto C = product(A, B, /*sort*/true);
+
+        plan.nrows = C->nrows;
+        plan.ncols = C->ncols;
+        plan.ptr.assign(C->ptr, C->ptr + C->nrows + 1);
+        plan.col.assign(C->col, C->col + C->nnz);
+
+        return C;
+    }
+
+    precondition(plan.nrows == A.nrows && plan.ncols == B.ncols,
+            "Product plan does not match the matrix sizes");
+
+    auto C = std::make_shared< crs<Val,Col,Ptr> >();
+    C->set_size(plan.nrows, plan.ncols);
+    C->set_nonzeros(plan.col.size());
+
+    C->ptr[0] = plan.ptr[0];
+#pragma omp parallel for
+    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(plan.nrows); ++i) {
+        C->ptr[i+1] = plan.ptr[i+1];
+        for(Ptr j = plan.ptr[i]; j < plan.ptr[i+1]; ++j)
+            C->col[j] = plan.col[j];
+    }
+
+    spgemm_numeric(A, B, *C);
+
+    return C;
+}
+
+/// Triple matrix-matrix product.
+/**
+ * Computes A * B * C row by row without storing the intermediate product
+ * A * B.
+ */
+template <class Val, class Col, class Ptr>
+std::shared_ptr< crs<Val, Col, Ptr> >
+product(const crs<Val,Col,Ptr> &A, const crs<Val,Col,Ptr> &B,
+        const crs<Val,Col,Ptr> &C, bool sort = false)
+{
+    auto D = std::make_shared< crs<Val,Col,Ptr> >();
+    spgemm_rap(A, B, C, *D, sort);
+    return D;
+}
+
+/// Triple matrix-matrix product reusing the product structure.
+template <class Val, class Col, class Ptr>
+std::shared_ptr< crs<Val, Col, Ptr> >
+product(const crs<Val,Col,Ptr> &A, const crs<Val,Col,Ptr> &B,
+        const crs<Val,Col,Ptr> &C, product_plan<Col, Ptr> &plan)
+{
+    if (plan.empty()) {
+        auto D = product(A, B, C, /*sort*/true);
+
+        plan.nrows = D->nrows;
+        plan.ncols = D->ncols;
+        plan.ptr.assign(D->ptr, D->ptr + D->nrows + 1);
+        plan.col.assign(D->col, D->col + D->nnz);
+
+        return D;
+    }
+
+    precondition(plan.nrows == A.nrows && plan.ncols == C.ncols,
+            "Product plan does not match the matrix sizes");
+
+    auto D = std::make_shared< crs<Val,Col,Ptr> >();
+    D->set_size(plan.nrows, plan.ncols);
+    D->set_nonzeros(plan.col.size());
+
+    D->ptr[0] = plan.ptr[0];
+#pragma omp parallel for
+    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(plan.nrows); ++i) {
+        D->ptr[i+1] = plan.ptr[i+1];
+        for(Ptr j = plan.ptr[i]; j < plan.ptr[i+1]; ++j)
+            D->col[j] = plan.col[j];
+    }
+
+    spgemm_rap_numeric(A, B, C, *D);
+
+    return D;
+}
+
 /// Sum of two matrices
 template <class Val, class Col, class Ptr>
 std::shared_ptr< crs<Val, Col, Ptr> >
@@ -670,11 +816,46 @@ class numa_vector {
             }
         }
 
+        /// Allocates the vector in the memory arena.
+        numa_vector(size_t n, std::shared_ptr<arena> pool, bool init = true)
+            : n(n), p(0), pool(pool)
+        {
+            p = allocate(n);
+
+            if (init) {
+#pragma omp parallel for
+                for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i)
+                    p[i] = math::zero<T>();
+            }
+        }
+
+        /// Allocates the vector with the thread to row mapping of the NUMA mode.
+        /**
+         * Each thread zero-initializes the part of the vector it owns, so that
+         * the memory pages are placed on the socket of the thread.
+         */
+        numa_vector(size_t n, std::shared_ptr<arena> pool,
+                std::shared_ptr<const numa_partition> part)
+            : n(n), p(0), pool(pool), part(part)
+        {
+            p = allocate(n);
+
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part.get(), n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i)
+                    p[i] = math::zero<T>();
+            }
+        }
+
         void resize(size_t size, bool init = true) {
-            delete[] p; p = 0;
+            if (!pool) delete[] p;
+            p = 0;
 
             n = size;
-            p = new T[n];
+            p = allocate(n);
 
             if (init) {
 #pragma omp parallel for
@@ -709,7 +890,8 @@ class numa_vector {
         }
 
         ~numa_vector() {
-            delete[] p; p = 0;
+            if (!pool) delete[] p;
+            p = 0;
         }
 
         inline size_t size() const {
@@ -735,11 +917,29 @@ class numa_vector {
         void swap(numa_vector &other) {
             std::swap(n, other.n);
             std::swap(p, other.p);
+            std::swap(pool, other.pool);
+            std::swap(part, other.part);
+        }
+
+        /// Memory arena holding the vector data (if any).
+        const std::shared_ptr<arena>& memory_pool() const {
+            return pool;
+        }
+
+        /// Thread to row mapping the vector was placed with (if any).
+        const std::shared_ptr<const numa_partition>& partition() const {
+            return part;
         }
 
     private:
         size_t n;
         T *p;
+        std::shared_ptr<arena> pool;
+        std::shared_ptr<const numa_partition> part;
+
+        T* allocate(size_t n) const {
+            return pool ? pool->template allocate_array<T>(n) : new T[n];
+        }
 };
 
 /// Diagonal of a matrix
@@ -902,6 +1102,61 @@ spectral_radius(const Matrix &A, int power_iters = 0) {
     return radius < 0 ? static_cast<scalar_type>(2) : radius;
 }
 
+/// The builtin backend parameters.
+struct builtin_params {
+    /// Memory arena for the hierarchy.
+    /**
+     * When set, the matrices and vectors created by the backend (the
+     * hierarchy operators, work vectors, and smoother data) are allocated in
+     * the arena, and are released all at once when the last of them is
+     * destroyed. The data is copied into the arena when the hierarchy is
+     * moved to the backend, so the setup time allocations are not affected.
+     */
+    std::shared_ptr<arena> pool;
+
+    /// Pool of work vectors.
+    /**
+     * When set, the iterative solvers and the AMG hierarchy borrow their
+     * work vectors from the pool for the duration of a solve instead of
+     * allocating them at construction. The solvers and preconditioners
+     * constructed with the same parameters then reuse the same vectors
+     * where their lifetimes do not overlap.
+     */
+    std::shared_ptr<workspace> scratch;
+
+    /// Thread to row mapping for NUMA systems.
+    /**
+     * When set, the rows of the matrices are split between the threads by
+     * the number of nonzeros, the matrix and vector data is placed in the
+     * memory of the socket owning the rows, and the matrix-vector products,
+     * residuals, and vector operations keep the same thread to row mapping.
+     * The threads should be pinned to the cores. See
+     * amgcl::backend::numa_layout.
+     */
+    std::shared_ptr<numa_layout> numa;
+
+    builtin_params() {}
+
+#ifndef AMGCL_NO_BOOST
+    builtin_params(const boost::property_tree::ptree &p)
+    {
+        if (p.get("use_arena", false))
+            pool = std::make_shared<arena>();
+        if (p.get("use_workspace", false))
+            scratch = std::make_shared<workspace>();
+        if (p.get("numa", false))
+            numa = std::make_shared<numa_layout>();
+        check_params(p, {"use_arena", "use_workspace", "numa"});
+    }
+
+    void get(boost::property_tree::ptree &p, const std::string &path) const {
+        p.put(path + "use_arena", static_cast<bool>(pool));
+        p.put(path + "use_workspace", static_cast<bool>(scratch));
+        p.put(path + "numa", static_cast<bool>(numa));
+    }
+#endif
+};
+
 /**
  * The builtin backend does not have any dependencies, and uses OpenMP for
  * parallelization. Matrices are stored in the CRS format, and vectors are
@@ -923,41 +1178,108 @@ struct builtin {
     typedef numa_vector<value_type>        matrix_diagonal;
     typedef solver::skyline_lu<value_type> direct_solver;
 
-    /// The backend has no parameters.
-    typedef amgcl::detail::empty_params params;
+    typedef builtin_params params;
 
     static std::string name() { return "builtin"; }
 
-    // Copy matrix. This is a noop for builtin backend.
+    // Copy matrix. This is a noop for builtin backend unless the memory
+    // arena or the NUMA mode is used.
     static std::shared_ptr<matrix>
-    copy_matrix(std::shared_ptr<matrix> A, const params&)
+    copy_matrix(std::shared_ptr<matrix> A, const params &prm)
     {
-        return A;
+        if ((!prm.pool || A->pool == prm.pool) && (!prm.numa || A->part))
+            return A;
+
+        auto B = std::make_shared<matrix>();
+        B->pool = prm.pool;
+
+        if (prm.numa)
+            B->part = prm.numa->rows(A->nrows, A->ptr);
+
+        B->set_size(A->nrows, A->ncols);
+        B->set_nonzeros(A->nnz);
+
+        // Each thread copies the rows it owns.
+        B->ptr[0] = A->ptr[0];
+#pragma omp parallel
+        {
+            ptrdiff_t beg, end;
+            detail::thread_rows(B->part.get(), A->nrows, beg, end);
+
+            for(ptrdiff_t i = beg; i < end; ++i) {
+                B->ptr[i+1] = A->ptr[i+1];
+                for(ptrdiff_t j = A->ptr[i]; j < A->ptr[i+1]; ++j) {
+                    B->col[j] = A->col[j];
+                    B->val[j] = A->val[j];
+                }
+            }
+        }
+
+        return B;
     }
 
     // Copy vector to builtin backend.
     template <class T>
     static std::shared_ptr< numa_vector<T> >
-    copy_vector(const std::vector<T> &x, const params&)
+    copy_vector(const std::vector<T> &x, const params &prm)
     {
-        return std::make_shared< numa_vector<T> >(x);
+        if (!prm.pool && !prm.numa) return std::make_shared< numa_vector<T> >(x);
+
+        auto y = allocate_vector<T>(x.size(), prm);
+        copy_data(x.data(), *y);
+        return y;
     }
 
-    // Copy vector to builtin backend. This is a noop for builtin backend.
+    // Copy vector to builtin backend. This is a noop for builtin backend
+    // unless the memory arena is used.
     template <class T>
     static std::shared_ptr< numa_vector<T> >
-    copy_vector(std::shared_ptr< numa_vector<T> > x, const params&)
+    copy_vector(std::shared_ptr< numa_vector<T> > x, const params &prm)
     {
-        return x;
+        if ((!prm.pool || x->memory_pool() == prm.pool) &&
+                (!prm.numa || x->partition())) return x;
+
+        auto y = allocate_vector<T>(x->size(), prm);
+        copy_data(x->data(), *y);
+        return y;
     }
 
     // Create vector of the specified size.
     static std::shared_ptr<vector>
-    create_vector(size_t size, const params&)
+    create_vector(size_t size, const params &prm)
+    {
+        return allocate_vector<rhs_type>(size, prm);
+    }
+
+    template <class T>
+    static std::shared_ptr< numa_vector<T> >
+    allocate_vector(size_t size, const params &prm)
+    {
+        if (prm.numa)
+            return std::make_shared< numa_vector<T> >(size, prm.pool, prm.numa->rows(size));
+        else if (prm.pool)
+            return std::make_shared< numa_vector<T> >(size, prm.pool);
+        else
+            return std::make_shared< numa_vector<T> >(size);
+    }
+
+    // Each thread copies the part of the vector it owns.
+    template <class T>
+    static void copy_data(const T *x, numa_vector<T> &y)
     {
-        return std::make_shared<vector>(size);
+        const ptrdiff_t n = y.size();
+#pragma omp parallel
+        {
+            ptrdiff_t beg, end;
+            detail::thread_rows(y.partition().get(), n, beg, end);
+
+            for(ptrdiff_t i = beg; i < end; ++i)
+                y[i] = x[i];
+        }
     }
 
+    // Short index lists (as in the halo exchange of the MPI backend) are
+    // processed serially, since they do not pay for starting a thread team.
     struct gather {
         std::vector<ptrdiff_t> I;
 
@@ -966,7 +1288,9 @@ struct builtin {
 
         template <class InVec, class OutVec>
         void operator()(const InVec &vec, OutVec &vals) const {
-            for(size_t i = 0; i < I.size(); ++i)
+            const ptrdiff_t n = I.size();
+#pragma omp parallel for if(n > 4096)
+            for(ptrdiff_t i = 0; i < n; ++i)
                 vals[i] = vec[I[i]];
         }
     };
@@ -979,7 +1303,9 @@ struct builtin {
 
         template <class InVec, class OutVec>
         void operator()(const InVec &vals, OutVec &vec) const {
-            for(size_t i = 0; i < I.size(); ++i)
+            const ptrdiff_t n = I.size();
+#pragma omp parallel for if(n > 4096)
+            for(ptrdiff_t i = 0; i < n; ++i)
                 vec[I[i]] = vals[i];
         }
     };
@@ -1006,6 +1332,15 @@ struct is_builtin_vector< numa_vector<V> > : std::true_type {};
 template <typename T1, typename T2>
 struct backends_compatible< builtin<T1>, builtin<T2> > : std::true_type {};
 
+template <typename V>
+struct single_precision<
+    builtin<V>,
+    typename std::enable_if< std::is_floating_point<V>::value >::type
+    >
+{
+    typedef builtin<float> type;
+};
+
 template < typename V, typename C, typename P >
 struct rows_impl< crs<V, C, P> > {
     static size_t get(const crs<V, C, P> &A) {
@@ -1081,9 +1416,15 @@ struct clear_impl<
         typedef typename backend::value_type<Vec>::type V;
 
         const size_t n = x.size();
-#pragma omp parallel for
-        for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-            x[i] = math::zero<V>();
+        const numa_partition *part = detail::row_partition(x);
+#pragma omp parallel
+        {
+            ptrdiff_t beg, end;
+            detail::thread_rows(part, n, beg, end);
+
+            for(ptrdiff_t i = beg; i < end; ++i) {
+                x[i] = math::zero<V>();
+            }
         }
     }
 };
@@ -1135,6 +1476,7 @@ struct inner_product_impl<
     static return_type parallel(const Vec1 &x, const Vec2 &y)
     {
         const size_t n = x.size();
+        const numa_partition *part = detail::row_partition(x);
         return_type              _sum_stat[AMGCL_MAX_OPENMP_THREADS];
         std::vector<return_type> _sum_dyna;
         return_type              *sum;
@@ -1155,8 +1497,10 @@ struct inner_product_impl<
             return_type s = math::zero<return_type>();
             return_type c = math::zero<return_type>();
 
-#pragma omp for nowait
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
+            ptrdiff_t beg, end;
+            detail::thread_rows(part, n, beg, end);
+
+            for(ptrdiff_t i = beg; i < end; ++i) {
                 return_type d = math::inner_product(x[i], y[i]) - c;
                 return_type t = s + d;
                 c = (t - s) - d;
@@ -1183,15 +1527,26 @@ struct axpby_impl<
     static void apply(A a, const Vec1 &x, B b, Vec2 &y)
     {
         const size_t n = x.size();
+        const numa_partition *part = detail::row_partition(y);
         if (!math::is_zero(b)) {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-                y[i] = a * x[i] + b * y[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    y[i] = a * x[i] + b * y[i];
+                }
             }
         } else {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-                y[i] = a * x[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    y[i] = a * x[i];
+                }
             }
         }
     }
@@ -1210,15 +1565,26 @@ struct axpbypcz_impl<
     static void apply(A a, const Vec1 &x, B b, const Vec2 &y, C c, Vec3 &z)
     {
         const size_t n = x.size();
+        const numa_partition *part = detail::row_partition(z);
         if (!math::is_zero(c)) {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-                z[i] = a * x[i] + b * y[i] + c * z[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    z[i] = a * x[i] + b * y[i] + c * z[i];
+                }
             }
         } else {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-                z[i] = a * x[i] + b * y[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    z[i] = a * x[i] + b * y[i];
+                }
             }
         }
     }
@@ -1239,15 +1605,26 @@ struct vmul_impl<
     static void apply(Alpha a, const Vec1 &x, const Vec2 &y, Beta b, Vec3 &z)
     {
         const size_t n = x.size();
+        const numa_partition *part = detail::row_partition(z);
         if (!math::is_zero(b)) {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-                z[i] = a * x[i] * y[i] + b * z[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    z[i] = a * x[i] * y[i] + b * z[i];
+                }
             }
         } else {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-                z[i] = a * x[i] * y[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    z[i] = a * x[i] * y[i];
+                }
             }
         }
     }
@@ -1277,19 +1654,30 @@ struct vmul_impl<
         typedef typename math::replace_scalar<x_type, typename math::scalar_of<typename value_type<Vec3>::type>::type>::type z_type;
 
         const size_t n = x.size();
+        const numa_partition *part = detail::row_partition(z);
 
         y_type const * yptr = reinterpret_cast<y_type const *>(&y[0]);
         z_type       * zptr = reinterpret_cast<z_type       *>(&z[0]);
 
         if (!math::is_zero(b)) {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-                zptr[i] = a * x[i] * yptr[i] + b * zptr[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    zptr[i] = a * x[i] * yptr[i] + b * zptr[i];
+                }
             }
         } else {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-                zptr[i] = a * x[i] * yptr[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    zptr[i] = a * x[i] * yptr[i];
+                }
             }
         }
     }
@@ -1307,9 +1695,193 @@ struct copy_impl<
     static void apply(const Vec1 &x, Vec2 &y)
     {
         const size_t n = x.size();
-#pragma omp parallel for
-        for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
-            y[i] = x[i];
+        const numa_partition *part = detail::row_partition(y);
+#pragma omp parallel
+        {
+            ptrdiff_t beg, end;
+            detail::thread_rows(part, n, beg, end);
+
+            for(ptrdiff_t i = beg; i < end; ++i) {
+                y[i] = x[i];
+            }
+        }
+    }
+};
+
+/// Transpose of the restriction operator for residual_restrict().
+/**
+ * The fine rows are split into blocks, one per thread, following the row
+ * partition of the system matrix. Each thread computes the residual in its
+ * block and adds it to the coarse rows through the rows of R^T, so that the
+ * fine-level residual is neither stored nor read back. A coarse row that
+ * depends on more than one block is shared, and is restricted with R after
+ * all blocks are done, from the residual values stored in t. With the
+ * aggregation-based coarsenings only a small fraction of the coarse rows
+ * (the aggregates on the block boundaries) is shared.
+ */
+template <typename V>
+struct transposed_restriction {
+    typedef crs<V, ptrdiff_t> matrix;
+
+    std::shared_ptr<matrix> RT;
+
+    // Boundaries of the fine row blocks.
+    numa_partition block;
+
+    // Marks the shared coarse rows.
+    std::vector<char> shared;
+
+    // The list of the shared coarse rows.
+    std::vector<ptrdiff_t> shared_rows;
+
+    transposed_restriction(const matrix &A, const matrix &R, const builtin_params &prm)
+        : RT(builtin<V>::copy_matrix(transpose(R), prm)), shared(R.nrows, 0)
+    {
+#ifdef _OPENMP
+        const int nt = omp_get_max_threads();
+#else
+        const int nt = 1;
+#endif
+        block.resize(nt + 1, A.nrows);
+        for(int t = 0; t < nt; ++t) {
+            ptrdiff_t end;
+            detail::thread_rows(A.part.get(), A.nrows, nt, t, block[t], end);
+        }
+
+        for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(R.nrows); ++i) {
+            ptrdiff_t beg = R.ptr[i], end = R.ptr[i+1];
+            if (beg == end) continue;
+
+            ptrdiff_t lo = R.col[beg], hi = lo;
+            for(ptrdiff_t j = beg + 1; j < end; ++j) {
+                lo = std::min(lo, R.col[j]);
+                hi = std::max(hi, R.col[j]);
+            }
+
+            if (hi >= *std::upper_bound(block.begin(), block.end(), lo)) {
+                shared[i] = 1;
+                shared_rows.push_back(i);
+            }
+        }
+    }
+
+    size_t bytes() const {
+        return backend::bytes(*RT)
+            + sizeof(ptrdiff_t) * (block.size() + shared_rows.size())
+            + shared.size();
+    }
+};
+
+// The fused operation only pays off when each fine row contributes to about
+// one coarse row (as with the non-smoothed aggregation). With a denser R the
+// scattered updates of the coarse vector cost more than the saved pass over
+// the residual, and the plan is not created.
+template <typename V>
+struct restriction_plan< builtin<V> > {
+    typedef transposed_restriction<V> type;
+
+    static std::shared_ptr<type> create(
+            const typename builtin<V>::matrix &A, const typename builtin<V>::matrix &R,
+            const builtin_params &prm)
+    {
+        if (R.nnz > A.nrows) return std::shared_ptr<type>();
+        return std::make_shared<type>(A, R, prm);
+    }
+};
+
+template <typename V, class Vec1, class Vec2, class Vec3, class Vec4>
+struct residual_restrict_impl<
+    crs<V, ptrdiff_t>, crs<V, ptrdiff_t>, transposed_restriction<V>,
+    Vec1, Vec2, Vec3, Vec4,
+    typename std::enable_if<
+        is_builtin_vector<Vec1>::value &&
+        is_builtin_vector<Vec2>::value &&
+        is_builtin_vector<Vec3>::value &&
+        is_builtin_vector<Vec4>::value &&
+        math::static_rows<V>::value == math::static_rows<typename value_type<Vec1>::type>::value &&
+        math::static_rows<V>::value == math::static_rows<typename value_type<Vec2>::type>::value &&
+        math::static_rows<V>::value == math::static_rows<typename value_type<Vec3>::type>::value &&
+        math::static_rows<V>::value == math::static_rows<typename value_type<Vec4>::type>::value
+        >::type
+    >
+{
+    typedef crs<V, ptrdiff_t> matrix;
+
+    static void apply(
+            const Vec1 &rhs, const matrix &A, const Vec2 &x,
+            const matrix &R, const transposed_restriction<V> *plan,
+            Vec3 &t, Vec4 &f)
+    {
+        typedef typename value_type<Vec3>::type T;
+        typedef typename value_type<Vec4>::type F;
+
+        if (!plan) {
+            residual(rhs, A, x, t);
+            spmv(math::identity<typename math::scalar_of<F>::type>(), R, t,
+                    math::zero<typename math::scalar_of<F>::type>(), f);
+            return;
+        }
+
+        const matrix &RT = *plan->RT;
+
+        const ptrdiff_t nc = R.nrows;
+        const ptrdiff_t nb = plan->block.size() - 1;
+        const ptrdiff_t ns = plan->shared_rows.size();
+
+        const numa_partition *part = detail::row_partition(f);
+
+#pragma omp parallel
+        {
+            ptrdiff_t beg, end;
+            detail::thread_rows(part, nc, beg, end);
+
+            for(ptrdiff_t i = beg; i < end; ++i)
+                f[i] = math::zero<F>();
+
+#ifdef _OPENMP
+            const int nt  = omp_get_num_threads();
+            const int tid = omp_get_thread_num();
+#else
+            const int nt  = 1;
+            const int tid = 0;
+#endif
+
+#pragma omp barrier
+
+            // The blocks are taken round-robin, so that all of them are
+            // processed when the team is smaller than the number of blocks
+            // (e.g. inside amgcl::detail::serial_region).
+            for(ptrdiff_t b = tid; b < nb; b += nt) {
+                for(ptrdiff_t i = plan->block[b], e = plan->block[b+1]; i < e; ++i) {
+                    T r = math::zero<T>();
+                    for(ptrdiff_t j = A.ptr[i], je = A.ptr[i+1]; j < je; ++j)
+                        math::mul_add(A.val[j], x[A.col[j]], r);
+                    r = rhs[i] - r;
+
+                    bool keep = false;
+                    for(ptrdiff_t j = RT.ptr[i], je = RT.ptr[i+1]; j < je; ++j) {
+                        ptrdiff_t c = RT.col[j];
+                        if (plan->shared[c])
+                            keep = true;
+                        else
+                            math::mul_add(RT.val[j], r, f[c]);
+                    }
+
+                    if (keep) t[i] = r;
+                }
+            }
+
+#pragma omp barrier
+
+#pragma omp for
+            for(ptrdiff_t k = 0; k < ns; ++k) {
+                ptrdiff_t i = plan->shared_rows[k];
+
+                F s = math::zero<F>();
+                for(ptrdiff_t j = R.ptr[i], je = R.ptr[i+1]; j < je; ++j)
+                    math::mul_add(R.val[j], t[R.col[j]], s);
+                f[i] = s;
+            }
         }
     }
 };
@@ -1321,6 +1893,20 @@ struct use_builtin_matrix_ops< amgcl::backend::crs<V, C, P> >
     : std::true_type
 {};
 
+template <typename V, typename C, typename P>
+struct row_partition_impl< amgcl::backend::crs<V, C, P> > {
+    static const numa_partition* get(const amgcl::backend::crs<V, C, P> &A) {
+        return A.part.get();
+    }
+};
+
+template <typename T>
+struct row_partition_impl< amgcl::backend::numa_vector<T> > {
+    static const numa_partition* get(const amgcl::backend::numa_vector<T> &x) {
+        return x.partition().get();
+    }
+};
+
 } // namespace detail
 
 } // namespace backend
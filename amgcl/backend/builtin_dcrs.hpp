@@ -0,0 +1,472 @@
+#ifndef AMGCL_BACKEND_BUILTIN_DCRS_HPP
+#define AMGCL_BACKEND_BUILTIN_DCRS_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/backend/builtin_dcrs.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Builtin backend with delta-compressed column indices.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <limits>
+#include <cstdint>
+
+#include <amgcl/util.hpp>
+#include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/builtin.hpp>
+#include <amgcl/solver/skyline_lu.hpp>
+
+namespace amgcl {
+namespace backend {
+
+/// Sparse matrix in CRS format with delta-compressed column indices.
+/**
+ * Each row stores its smallest column number, and the column numbers of the
+ * row nonzeros are stored as 16-bit (or, when the row spans are too wide,
+ * 32-bit) offsets from it. With double precision values this reduces the
+ * memory traffic of the matrix-vector product by 30-40% compared to the
+ * regular CRS format with 64-bit column numbers.
+ *
+ * When the span of a row does not fit into 32 bits, the matrix is kept in the
+ * CRS format.
+ *
+ * \param V Value type.
+ * \param Col Column number type.
+ * \param Ptr Index type.
+ */
+template <typename V, typename Col = ptrdiff_t, typename Ptr = Col>
+struct dcrs {
+    typedef V   value_type;
+    typedef V   val_type;
+    typedef Col col_type;
+    typedef Ptr ptr_type;
+
+    typedef crs<V, Col, Ptr> crs_type;
+
+    size_t nrows, ncols, nnz;
+
+    // Set when the matrix is stored in CRS format.
+    std::shared_ptr<crs_type> A;
+
+    numa_vector<Ptr>      ptr;
+    numa_vector<Col>      base;  // smallest column number in each row.
+    numa_vector<uint16_t> d16;   // column offsets (narrow).
+    numa_vector<uint32_t> d32;   // column offsets (wide).
+    numa_vector<V>        val;
+
+    /// Converts matrix in CRS format to the delta-compressed format.
+    dcrs(std::shared_ptr<crs_type> A)
+        : nrows(backend::rows(*A)), ncols(backend::cols(*A)),
+          nnz(backend::nonzeros(*A))
+    {
+        const ptrdiff_t n = nrows;
+
+        base.resize(n, false);
+
+        // Find the row spans.
+        ptrdiff_t span = 0;
+
+#pragma omp parallel
+        {
+            ptrdiff_t my_span = 0;
+
+#pragma omp for
+            for(ptrdiff_t i = 0; i < n; ++i) {
+                Ptr beg = A->ptr[i], end = A->ptr[i+1];
+
+                if (beg == end) {
+                    base[i] = 0;
+                    continue;
+                }
+
+                Col lo = A->col[beg], hi = A->col[beg];
+                for(Ptr j = beg + 1; j < end; ++j) {
+                    lo = std::min(lo, A->col[j]);
+                    hi = std::max(hi, A->col[j]);
+                }
+
+                base[i] = lo;
+                my_span = std::max<ptrdiff_t>(my_span, hi - lo);
+            }
+
+#pragma omp critical
+            span = std::max(span, my_span);
+        }
+
+        if (span > std::numeric_limits<uint32_t>::max()) {
+            // The rows are too wide, keep the matrix in CRS format.
+            this->A = A;
+            base.resize(0, false);
+            return;
+        }
+
+        ptr.resize(n + 1, false);
+        val.resize(nnz, false);
+
+        if (span <= std::numeric_limits<uint16_t>::max()) {
+            d16.resize(nnz, false);
+            fill(*A, d16);
+        } else {
+            d32.resize(nnz, false);
+            fill(*A, d32);
+        }
+    }
+
+    /// Is the matrix stored with compressed column indices?
+    bool is_compressed() const {
+        return !A;
+    }
+
+    /// Are the column offsets 16-bit wide?
+    bool is_narrow() const {
+        return d16.size() == nnz;
+    }
+
+    class row_iterator {
+        public:
+            row_iterator(
+                    const crs_type *A,
+                    const dcrs *M,
+                    size_t row
+                    ) : A(A), M(M), row(row)
+            {
+                if (A) {
+                    m_pos = A->ptr[row];
+                    m_end = A->ptr[row + 1];
+                } else {
+                    m_pos = M->ptr[row];
+                    m_end = M->ptr[row + 1];
+                }
+            }
+
+            operator bool() const {
+                return m_pos < m_end;
+            }
+
+            row_iterator& operator++() {
+                ++m_pos;
+                return *this;
+            }
+
+            col_type col() const {
+                if (A) return A->col[m_pos];
+
+                return M->base[row] + (M->is_narrow()
+                        ? static_cast<col_type>(M->d16[m_pos])
+                        : static_cast<col_type>(M->d32[m_pos]));
+            }
+
+            val_type value() const {
+                return A ? A->val[m_pos] : M->val[m_pos];
+            }
+
+        private:
+            const crs_type *A;
+            const dcrs *M;
+            size_t row;
+            ptr_type m_pos, m_end;
+    };
+
+    row_iterator row_begin(size_t row) const {
+        return row_iterator(A.get(), this, row);
+    }
+
+    size_t bytes() const {
+        if (A) return backend::bytes(*A);
+
+        return sizeof(ptr_type) * ptr.size()
+             + sizeof(col_type) * base.size()
+             + sizeof(uint16_t) * d16.size()
+             + sizeof(uint32_t) * d32.size()
+             + sizeof(val_type) * val.size();
+    }
+
+    private:
+        template <class Delta>
+        void fill(const crs_type &A, numa_vector<Delta> &delta) {
+            const ptrdiff_t n = nrows;
+
+            ptr[0] = 0;
+
+            // Same schedule as in the kernels, so that the memory pages
+            // are touched by the threads that will work with them.
+#pragma omp parallel for
+            for(ptrdiff_t i = 0; i < n; ++i) {
+                ptr[i+1] = A.ptr[i+1];
+
+                Col b = base[i];
+                for(Ptr j = A.ptr[i], e = A.ptr[i+1]; j < e; ++j) {
+                    delta[j] = static_cast<Delta>(A.col[j] - b);
+                    val[j]   = A.val[j];
+                }
+            }
+        }
+};
+
+/// Builtin backend with delta-compressed column indices.
+/**
+ * Vectors are the same as in the builtin backend, and the backend is
+ * compatible with it. Matrices are stored in the CRS format, where the column
+ * numbers are replaced with 16-bit or 32-bit offsets from the first column of
+ * each row. The memory-bound matrix-vector products are faster due to the
+ * reduced memory traffic, and larger problems fit into the available memory.
+ *
+ * \param real Value type.
+ * \ingroup backends
+ */
+template <typename real>
+struct builtin_dcrs {
+    typedef real      value_type;
+    typedef ptrdiff_t index_type;
+
+    typedef typename math::rhs_of<value_type>::type rhs_type;
+
+    struct provides_row_iterator : std::true_type {};
+
+    typedef dcrs<real, index_type>                  matrix;
+    typedef typename builtin<real>::vector          vector;
+    typedef typename builtin<real>::matrix_diagonal matrix_diagonal;
+    typedef typename builtin<real>::direct_solver   direct_solver;
+
+    /// Backend parameters.
+    struct params {
+        params() {}
+
+#ifndef AMGCL_NO_BOOST
+        params(const boost::property_tree::ptree &p) {
+            check_params(p, {});
+        }
+
+        void get(boost::property_tree::ptree&, const std::string&) const {}
+#endif
+    };
+
+    static std::string name() { return "builtin_dcrs"; }
+
+    /// Copy matrix from builtin backend.
+    static std::shared_ptr<matrix>
+    copy_matrix(std::shared_ptr< typename builtin<real>::matrix > A, const params&)
+    {
+        return std::make_shared<matrix>(A);
+    }
+
+    /// Copy vector to builtin backend.
+    template <class T>
+    static std::shared_ptr< numa_vector<T> >
+    copy_vector(const std::vector<T> &x, const params&)
+    {
+        return std::make_shared< numa_vector<T> >(x);
+    }
+
+    /// Copy vector to builtin backend. This is a noop.
+    template <class T>
+    static std::shared_ptr< numa_vector<T> >
+    copy_vector(std::shared_ptr< numa_vector<T> > x, const params&)
+    {
+        return x;
+    }
+
+    /// Create vector of the specified size.
+    static std::shared_ptr<vector>
+    create_vector(size_t size, const params&)
+    {
+        return std::make_shared<vector>(size);
+    }
+
+    struct gather : builtin<real>::gather {
+        gather(size_t size, const std::vector<ptrdiff_t> &I, const params&)
+            : builtin<real>::gather(size, I, typename builtin<real>::params()) { }
+    };
+
+    struct scatter : builtin<real>::scatter {
+        scatter(size_t size, const std::vector<ptrdiff_t> &I, const params&)
+            : builtin<real>::scatter(size, I, typename builtin<real>::params()) { }
+    };
+
+    /// Create direct solver for coarse level
+    static std::shared_ptr<direct_solver>
+    create_solver(std::shared_ptr< typename builtin<real>::matrix > A, const params&)
+    {
+        return std::make_shared<direct_solver>(*A);
+    }
+};
+
+//---------------------------------------------------------------------------
+// Specialization of backend interface
+//---------------------------------------------------------------------------
+template <typename T1, typename T2>
+struct backends_compatible< builtin_dcrs<T1>, builtin<T2> > : std::true_type {};
+
+template <typename T1, typename T2>
+struct backends_compatible< builtin<T1>, builtin_dcrs<T2> > : std::true_type {};
+
+template <typename T1, typename T2>
+struct backends_compatible< builtin_dcrs<T1>, builtin_dcrs<T2> > : std::true_type {};
+
+template < typename V, typename Col, typename Ptr >
+struct rows_impl< dcrs<V, Col, Ptr> > {
+    static size_t get(const dcrs<V, Col, Ptr> &A) {
+        return A.nrows;
+    }
+};
+
+template < typename V, typename Col, typename Ptr >
+struct cols_impl< dcrs<V, Col, Ptr> > {
+    static size_t get(const dcrs<V, Col, Ptr> &A) {
+        return A.ncols;
+    }
+};
+
+template < typename V, typename Col, typename Ptr >
+struct nonzeros_impl< dcrs<V, Col, Ptr> > {
+    static size_t get(const dcrs<V, Col, Ptr> &A) {
+        return A.nnz;
+    }
+};
+
+template < typename V, typename Col, typename Ptr >
+struct row_nonzeros_impl< dcrs<V, Col, Ptr> > {
+    static size_t get(const dcrs<V, Col, Ptr> &A, size_t row) {
+        if (A.is_compressed())
+            return A.ptr[row + 1] - A.ptr[row];
+        else
+            return A.A->ptr[row + 1] - A.A->ptr[row];
+    }
+};
+
+template <class Alpha, typename V, typename Col, typename Ptr, class Vector1, class Beta, class Vector2>
+struct spmv_impl<
+    Alpha, dcrs<V, Col, Ptr>, Vector1, Beta, Vector2,
+    typename std::enable_if<
+        is_builtin_vector<Vector1>::value &&
+        is_builtin_vector<Vector2>::value
+        >::type
+    >
+{
+    typedef dcrs<V, Col, Ptr> matrix;
+
+    static void apply(
+            Alpha alpha, const matrix &A, const Vector1 &x, Beta beta, Vector2 &y
+            )
+    {
+        if (!A.is_compressed()) {
+            backend::spmv(alpha, *A.A, x, beta, y);
+        } else if (A.is_narrow()) {
+            apply(alpha, A, A.d16.data(), x, beta, y);
+        } else {
+            apply(alpha, A, A.d32.data(), x, beta, y);
+        }
+    }
+
+    template <class Delta>
+    static void apply(
+            Alpha alpha, const matrix &A, const Delta *delta,
+            const Vector1 &x, Beta beta, Vector2 &y
+            )
+    {
+        typedef typename value_type<Vector2>::type T;
+
+        const ptrdiff_t n = A.nrows;
+
+        const bool has_beta = !math::is_zero(beta);
+
+#pragma omp parallel for
+        for(ptrdiff_t i = 0; i < n; ++i) {
+            T sum = math::zero<T>();
+
+            const Col b = A.base[i];
+            for(Ptr j = A.ptr[i], e = A.ptr[i+1]; j < e; ++j)
+                math::mul_add(A.val[j], x[b + delta[j]], sum);
+
+            if (has_beta)
+                y[i] = alpha * sum + beta * y[i];
+            else
+                y[i] = alpha * sum;
+        }
+    }
+};
+
+template <typename V, typename Col, typename Ptr, class Vector1, class Vector2, class Vector3>
+struct residual_impl<
+    dcrs<V, Col, Ptr>, Vector1, Vector2, Vector3,
+    typename std::enable_if<
+        is_builtin_vector<Vector1>::value &&
+        is_builtin_vector<Vector2>::value &&
+        is_builtin_vector<Vector3>::value
+        >::type
+    >
+{
+    typedef dcrs<V, Col, Ptr> matrix;
+
+    static void apply(
+            Vector1 const &rhs,
+            matrix  const &A,
+            Vector2 const &x,
+            Vector3       &res
+            )
+    {
+        if (!A.is_compressed()) {
+            backend::residual(rhs, *A.A, x, res);
+        } else if (A.is_narrow()) {
+            apply(rhs, A, A.d16.data(), x, res);
+        } else {
+            apply(rhs, A, A.d32.data(), x, res);
+        }
+    }
+
+    template <class Delta>
+    static void apply(
+            Vector1 const &rhs,
+            matrix  const &A,
+            const Delta   *delta,
+            Vector2 const &x,
+            Vector3       &res
+            )
+    {
+        typedef typename value_type<Vector3>::type T;
+
+        const ptrdiff_t n = A.nrows;
+
+#pragma omp parallel for
+        for(ptrdiff_t i = 0; i < n; ++i) {
+            T sum = math::zero<T>();
+
+            const Col b = A.base[i];
+            for(Ptr j = A.ptr[i], e = A.ptr[i+1]; j < e; ++j)
+                math::mul_add(A.val[j], x[b + delta[j]], sum);
+
+            res[i] = rhs[i] - sum;
+        }
+    }
+};
+
+} // namespace backend
+} // namespace amgcl
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef AMGCL_BACKEND_BUILTIN_MRHS_HPP
+#define AMGCL_BACKEND_BUILTIN_MRHS_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/backend/builtin_mrhs.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Builtin backend for solution of systems with multiple right-hand sides.
+ */
+
+#include <vector>
+#include <memory>
+
+#include <amgcl/backend/builtin.hpp>
+#include <amgcl/value_type/multi_rhs.hpp>
+#include <amgcl/solver/skyline_lu.hpp>
+
+namespace amgcl {
+namespace backend {
+
+/// Builtin backend for systems with multiple right-hand sides.
+/**
+ * The matrices are the same as in the builtin backend, but the vectors hold
+ * K interleaved vectors (each element is an amgcl::multi_rhs<real,K>).
+ * The matrix is read once per spmv for all of the vectors, and the
+ * iterative solvers handle K independent systems at once.
+ *
+ * \param real Value type (scalar).
+ * \param K    Number of right-hand sides.
+ * \ingroup backends
+ */
+template <typename real, int K>
+struct builtin_mrhs {
+    static_assert(!math::is_static_matrix<real>::value,
+            "builtin_mrhs only supports scalar value types");
+
+    typedef real      value_type;
+    typedef ptrdiff_t index_type;
+
+    typedef multi_rhs<real, K> rhs_type;
+
+    struct provides_row_iterator : std::true_type {};
+
+    typedef typename builtin<real>::matrix          matrix;
+    typedef numa_vector<rhs_type>                   vector;
+    typedef typename builtin<real>::matrix_diagonal matrix_diagonal;
+    typedef typename builtin<real>::params          params;
+    typedef typename builtin<real>::gather          gather;
+    typedef typename builtin<real>::scatter         scatter;
+
+    /// Coarse level solver.
+    /**
+     * Solves for each of the right-hand sides in turn with the skyline LU
+     * factorization of the coarse matrix.
+     */
+    struct direct_solver {
+        typedef typename builtin<real>::direct_solver base_solver;
+
+        base_solver S;
+        mutable std::vector<real> f, x;
+
+        static size_t coarse_enough() {
+            return base_solver::coarse_enough();
+        }
+
+        direct_solver(const matrix &A) : S(A), f(rows(A)), x(rows(A)) {}
+
+        template <class Vec1, class Vec2>
+        void operator()(const Vec1 &rhs, Vec2 &u) const {
+            const size_t n = f.size();
+
+            for(int k = 0; k < K; ++k) {
+                for(size_t i = 0; i < n; ++i) f[i] = rhs[i](k);
+                S(f, x);
+                for(size_t i = 0; i < n; ++i) u[i](k) = x[i];
+            }
+        }
+
+        size_t bytes() const {
+            return backend::bytes(S) + backend::bytes(f) + backend::bytes(x);
+        }
+    };
+
+    static std::string name() { return "builtin_mrhs"; }
+
+    /// Copy matrix. Same as in the builtin backend.
+    static std::shared_ptr<matrix>
+    copy_matrix(std::shared_ptr<matrix> A, const params &prm)
+    {
+        return builtin<real>::copy_matrix(A, prm);
+    }
+
+    /// Copy vector to the backend. Same as in the builtin backend.
+    template <class T>
+    static std::shared_ptr< numa_vector<T> >
+    copy_vector(const std::vector<T> &x, const params &prm)
+    {
+        return builtin<real>::copy_vector(x, prm);
+    }
+
+    /// Copy vector to the backend. Same as in the builtin backend.
+    template <class T>
+    static std::shared_ptr< numa_vector<T> >
+    copy_vector(std::shared_ptr< numa_vector<T> > x, const params &prm)
+    {
+        return builtin<real>::copy_vector(x, prm);
+    }
+
+    /// Create block vector of the specified size.
+    static std::shared_ptr<vector>
+    create_vector(size_t size, const params &prm)
+    {
+        if (prm.pool)
+            return std::make_shared<vector>(size, prm.pool);
+        else
+            return std::make_shared<vector>(size);
+    }
+
+    /// Create direct solver for coarse level
+    static std::shared_ptr<direct_solver>
+    create_solver(std::shared_ptr<matrix> A, const params&)
+    {
+        return std::make_shared<direct_solver>(*A);
+    }
+};
+
+template <typename real, int K>
+struct vector_value_type< builtin_mrhs<real, K> > {
+    typedef multi_rhs<real, K> type;
+};
+
+template <typename T1, typename T2, int K>
+struct backends_compatible< builtin_mrhs<T1, K>, builtin_mrhs<T2, K> > : std::true_type {};
+
+} // namespace backend
+} // namespace amgcl
+
+#endif
@@ -0,0 +1,501 @@
+#ifndef AMGCL_BACKEND_BUILTIN_SELL_HPP
+#define AMGCL_BACKEND_BUILTIN_SELL_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/backend/builtin_sell.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Builtin backend with matrices stored in SELL-C-sigma format.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+#include <amgcl/util.hpp>
+#include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/builtin.hpp>
+#include <amgcl/solver/skyline_lu.hpp>
+
+namespace amgcl {
+namespace backend {
+
+/// Sparse matrix in SELL-C-sigma (sliced ELLPACK) format.
+/**
+ * Rows are split into chunks of C consecutive rows, and each chunk is stored
+ * in column-major order padded to the length of its longest row, so that the
+ * matrix-vector product processes C rows at once with unit-stride memory
+ * access. Before the chunks are formed, rows inside each window of sigma
+ * rows are sorted by their length in order to reduce the padding.
+ *
+ * When the padding overhead of a matrix exceeds the given threshold (that is,
+ * the row lengths vary too much), the matrix is kept in the CRS format.
+ *
+ * \param V Value type.
+ * \param C Chunk size (number of rows processed at once).
+ * \param Col Column number type.
+ * \param Ptr Index type.
+ */
+template <typename V, int C, typename Col = ptrdiff_t, typename Ptr = Col>
+struct sell {
+    typedef V   value_type;
+    typedef V   val_type;
+    typedef Col col_type;
+    typedef Ptr ptr_type;
+
+    typedef crs<V, Col, Ptr> crs_type;
+
+    size_t nrows, ncols, nnz, nchunks;
+
+    // Set when the matrix is stored in CRS format.
+    std::shared_ptr<crs_type> A;
+
+    numa_vector<Ptr> chunk_ptr; // start of each chunk.
+    numa_vector<Ptr> row_width; // number of nonzeros in each (permuted) row.
+    numa_vector<Ptr> perm;      // original row number for each permuted row.
+    numa_vector<Ptr> slot;      // permuted position for each original row.
+    numa_vector<Col> col;
+    numa_vector<V>   val;
+
+    /// Converts matrix in CRS format to SELL-C-sigma format.
+    /**
+     * \param A        Input matrix.
+     * \param sigma    Size of the sorting window.
+     * \param max_fill Maximum allowed ratio of padded to actual nonzeros.
+     */
+    sell(std::shared_ptr<crs_type> A, size_t sigma, float max_fill)
+        : nrows(backend::rows(*A)), ncols(backend::cols(*A)),
+          nnz(backend::nonzeros(*A)), nchunks((nrows + C - 1) / C)
+    {
+        const ptrdiff_t n = nrows;
+        const ptrdiff_t m = nchunks;
+
+        // Sort rows inside each window by their length.
+        perm.resize(n, false);
+
+        if (sigma < 1) sigma = 1;
+        const ptrdiff_t nwin = (n + sigma - 1) / sigma;
+
+#pragma omp parallel for
+        for(ptrdiff_t w = 0; w < nwin; ++w) {
+            ptrdiff_t beg = w * sigma;
+            ptrdiff_t end = std::min<ptrdiff_t>(beg + sigma, n);
+
+            for(ptrdiff_t i = beg; i < end; ++i) perm[i] = i;
+
+            if (sigma > 1)
+                std::stable_sort(&perm[beg], &perm[0] + end, row_longer(*A));
+        }
+
+        // Find chunk widths and the padded matrix size.
+        chunk_ptr.resize(m + 1, false);
+        chunk_ptr[0] = 0;
+
+#pragma omp parallel for
+        for(ptrdiff_t c = 0; c < m; ++c) {
+            Ptr w = 0;
+            for(ptrdiff_t i = c * C, e = std::min<ptrdiff_t>(i + C, n); i < e; ++i)
+                w = std::max<Ptr>(w, row_nonzeros(*A, perm[i]));
+            chunk_ptr[c+1] = w * C;
+        }
+
+        std::partial_sum(chunk_ptr.data(), chunk_ptr.data() + m + 1, chunk_ptr.data());
+
+        if (chunk_ptr[m] > max_fill * nnz) {
+            // Row lengths vary too much, keep the matrix in CRS format.
+            this->A = A;
+            chunk_ptr.resize(0, false);
+            perm.resize(0, false);
+            return;
+        }
+
+        row_width.resize(m * C, false);
+        slot.resize(n, false);
+        col.resize(chunk_ptr[m], false);
+        val.resize(chunk_ptr[m], false);
+
+#pragma omp parallel for
+        for(ptrdiff_t c = 0; c < m; ++c) {
+            Ptr beg = chunk_ptr[c];
+            Ptr w   = (chunk_ptr[c+1] - beg) / C;
+
+            for(int l = 0; l < C; ++l) {
+                ptrdiff_t s = c * C + l;
+                Ptr j = beg + l;
+
+                if (s < n) {
+                    ptrdiff_t i = perm[s];
+                    slot[i] = s;
+                    row_width[s] = A->ptr[i+1] - A->ptr[i];
+
+                    for(Ptr k = A->ptr[i], e = A->ptr[i+1]; k < e; ++k, j += C) {
+                        col[j] = A->col[k];
+                        val[j] = A->val[k];
+                    }
+
+                    // Pad the row with zeros referencing the diagonal.
+                    for(Ptr k = row_width[s]; k < w; ++k, j += C) {
+                        col[j] = std::min<ptrdiff_t>(i, ncols - 1);
+                        val[j] = math::zero<V>();
+                    }
+                } else {
+                    row_width[s] = 0;
+
+                    for(Ptr k = 0; k < w; ++k, j += C) {
+                        col[j] = 0;
+                        val[j] = math::zero<V>();
+                    }
+                }
+            }
+        }
+    }
+
+    /// Is the matrix stored in SELL-C-sigma format?
+    bool is_sell() const {
+        return !A;
+    }
+
+    class row_iterator {
+        public:
+            row_iterator(
+                    const col_type * col,
+                    const val_type * val,
+                    ptrdiff_t n, ptrdiff_t stride
+                    ) : m_col(col), m_val(val), m_n(n), m_stride(stride)
+            {}
+
+            operator bool() const {
+                return m_n > 0;
+            }
+
+            row_iterator& operator++() {
+                m_col += m_stride;
+                m_val += m_stride;
+                --m_n;
+                return *this;
+            }
+
+            col_type col() const {
+                return *m_col;
+            }
+
+            val_type value() const {
+                return *m_val;
+            }
+
+        private:
+            const col_type * m_col;
+            const val_type * m_val;
+            ptrdiff_t m_n;
+            ptrdiff_t m_stride;
+    };
+
+    row_iterator row_begin(size_t row) const {
+        if (A) {
+            ptr_type p = A->ptr[row];
+            ptr_type e = A->ptr[row + 1];
+            return row_iterator(A->col + p, A->val + p, e - p, 1);
+        } else {
+            ptr_type s = slot[row];
+            ptr_type j = chunk_ptr[s / C] + s % C;
+            return row_iterator(col.data() + j, val.data() + j, row_width[s], C);
+        }
+    }
+
+    size_t bytes() const {
+        if (A) return backend::bytes(*A);
+
+        return sizeof(ptr_type) * (chunk_ptr.size() + row_width.size() + perm.size() + slot.size())
+             + sizeof(col_type) * col.size()
+             + sizeof(val_type) * val.size();
+    }
+
+    private:
+        struct row_longer {
+            const crs_type &A;
+
+            row_longer(const crs_type &A) : A(A) {}
+
+            bool operator()(ptrdiff_t a, ptrdiff_t b) const {
+                return A.ptr[a+1] - A.ptr[a] > A.ptr[b+1] - A.ptr[b];
+            }
+        };
+};
+
+/// Builtin backend with matrices stored in SELL-C-sigma format.
+/**
+ * Vectors are the same as in the builtin backend, and the backend is
+ * compatible with it. The SELL-C-sigma format is used for the matrices with
+ * uniform enough row lengths, the rest of the matrices are kept in CRS
+ * format.
+ *
+ * \param real      Value type.
+ * \param ChunkSize Number of rows in a chunk. Should match the SIMD width of
+ *                  the target architecture (e.g. 4 for AVX2 or 8 for AVX-512
+ *                  with double precision values).
+ * \ingroup backends
+ */
+template <typename real, int ChunkSize = 8>
+struct builtin_sell {
+    typedef real      value_type;
+    typedef ptrdiff_t index_type;
+
+    typedef typename math::rhs_of<value_type>::type rhs_type;
+
+    struct provides_row_iterator : std::true_type {};
+
+    typedef sell<real, ChunkSize, index_type>  matrix;
+    typedef typename builtin<real>::vector          vector;
+    typedef typename builtin<real>::matrix_diagonal matrix_diagonal;
+    typedef typename builtin<real>::direct_solver   direct_solver;
+
+    /// Backend parameters.
+    struct params {
+        /// Size of the window inside which the rows are sorted by length.
+        size_t sigma;
+
+        /// Maximum allowed ratio of padded to actual nonzeros.
+        /**
+         * Matrices with the SELL-C-sigma padding overhead larger than this
+         * are kept in the CRS format.
+         */
+        float max_fill;
+
+        params() : sigma(32 * ChunkSize), max_fill(1.25f) {}
+
+#ifndef AMGCL_NO_BOOST
+        params(const boost::property_tree::ptree &p)
+            : AMGCL_PARAMS_IMPORT_VALUE(p, sigma),
+              AMGCL_PARAMS_IMPORT_VALUE(p, max_fill)
+        {
+            check_params(p, {"sigma", "max_fill"});
+        }
+
+        void get(boost::property_tree::ptree &p, const std::string &path) const {
+            AMGCL_PARAMS_EXPORT_VALUE(p, path, sigma);
+            AMGCL_PARAMS_EXPORT_VALUE(p, path, max_fill);
+        }
+#endif
+    };
+
+    static std::string name() { return "builtin_sell"; }
+
+    /// Copy matrix from builtin backend.
+    static std::shared_ptr<matrix>
+    copy_matrix(std::shared_ptr< typename builtin<real>::matrix > A, const params &prm)
+    {
+        return std::make_shared<matrix>(A, prm.sigma, prm.max_fill);
+    }
+
+    /// Copy vector to builtin backend.
+    template <class T>
+    static std::shared_ptr< numa_vector<T> >
+    copy_vector(const std::vector<T> &x, const params&)
+    {
+        return std::make_shared< numa_vector<T> >(x);
+    }
+
+    /// Copy vector to builtin backend. This is a noop.
+    template <class T>
+    static std::shared_ptr< numa_vector<T> >
+    copy_vector(std::shared_ptr< numa_vector<T> > x, const params&)
+    {
+        return x;
+    }
+
+    /// Create vector of the specified size.
+    static std::shared_ptr<vector>
+    create_vector(size_t size, const params&)
+    {
+        return std::make_shared<vector>(size);
+    }
+
+    struct gather : builtin<real>::gather {
+        gather(size_t size, const std::vector<ptrdiff_t> &I, const params&)
+            : builtin<real>::gather(size, I, typename builtin<real>::params()) { }
+    };
+
+    struct scatter : builtin<real>::scatter {
+        scatter(size_t size, const std::vector<ptrdiff_t> &I, const params&)
+            : builtin<real>::scatter(size, I, typename builtin<real>::params()) { }
+    };
+
+    /// Create direct solver for coarse level
+    static std::shared_ptr<direct_solver>
+    create_solver(std::shared_ptr< typename builtin<real>::matrix > A, const params&)
+    {
+        return std::make_shared<direct_solver>(*A);
+    }
+};
+
+//---------------------------------------------------------------------------
+// Specialization of backend interface
+//---------------------------------------------------------------------------
+template <typename T1, typename T2, int C>
+struct backends_compatible< builtin_sell<T1, C>, builtin<T2> > : std::true_type {};
+
+template <typename T1, typename T2, int C>
+struct backends_compatible< builtin<T1>, builtin_sell<T2, C> > : std::true_type {};
+
+template <typename T1, typename T2, int C1, int C2>
+struct backends_compatible< builtin_sell<T1, C1>, builtin_sell<T2, C2> > : std::true_type {};
+
+template < typename V, int C, typename Col, typename Ptr >
+struct rows_impl< sell<V, C, Col, Ptr> > {
+    static size_t get(const sell<V, C, Col, Ptr> &A) {
+        return A.nrows;
+    }
+};
+
+template < typename V, int C, typename Col, typename Ptr >
+struct cols_impl< sell<V, C, Col, Ptr> > {
+    static size_t get(const sell<V, C, Col, Ptr> &A) {
+        return A.ncols;
+    }
+};
+
+template < typename V, int C, typename Col, typename Ptr >
+struct nonzeros_impl< sell<V, C, Col, Ptr> > {
+    static size_t get(const sell<V, C, Col, Ptr> &A) {
+        return A.nnz;
+    }
+};
+
+template < typename V, int C, typename Col, typename Ptr >
+struct row_nonzeros_impl< sell<V, C, Col, Ptr> > {
+    static size_t get(const sell<V, C, Col, Ptr> &A, size_t row) {
+        if (A.is_sell())
+            return A.row_width[A.slot[row]];
+        else
+            return A.A->ptr[row + 1] - A.A->ptr[row];
+    }
+};
+
+template <class Alpha, typename V, int C, typename Col, typename Ptr, class Vector1, class Beta, class Vector2>
+struct spmv_impl<
+    Alpha, sell<V, C, Col, Ptr>, Vector1, Beta, Vector2,
+    typename std::enable_if<
+        is_builtin_vector<Vector1>::value &&
+        is_builtin_vector<Vector2>::value
+        >::type
+    >
+{
+    typedef sell<V, C, Col, Ptr> matrix;
+
+    static void apply(
+            Alpha alpha, const matrix &A, const Vector1 &x, Beta beta, Vector2 &y
+            )
+    {
+        typedef typename value_type<Vector2>::type T;
+
+        if (!A.is_sell()) {
+            backend::spmv(alpha, *A.A, x, beta, y);
+            return;
+        }
+
+        const ptrdiff_t n = A.nrows;
+        const ptrdiff_t m = A.nchunks;
+
+        const bool has_beta = !math::is_zero(beta);
+
+#pragma omp parallel for
+        for(ptrdiff_t c = 0; c < m; ++c) {
+            T sum[C];
+            for(int l = 0; l < C; ++l) sum[l] = math::zero<T>();
+
+            const Col *col = A.col.data() + A.chunk_ptr[c];
+            const V   *val = A.val.data() + A.chunk_ptr[c];
+            const Col *end = A.col.data() + A.chunk_ptr[c+1];
+
+            for(; col < end; col += C, val += C)
+                for(int l = 0; l < C; ++l)
+                    math::mul_add(val[l], x[col[l]], sum[l]);
+
+            for(int l = 0, s = c * C; l < C && s < n; ++l, ++s) {
+                ptrdiff_t i = A.perm[s];
+                if (has_beta)
+                    y[i] = alpha * sum[l] + beta * y[i];
+                else
+                    y[i] = alpha * sum[l];
+            }
+        }
+    }
+};
+
+template <typename V, int C, typename Col, typename Ptr, class Vector1, class Vector2, class Vector3>
+struct residual_impl<
+    sell<V, C, Col, Ptr>, Vector1, Vector2, Vector3,
+    typename std::enable_if<
+        is_builtin_vector<Vector1>::value &&
+        is_builtin_vector<Vector2>::value &&
+        is_builtin_vector<Vector3>::value
+        >::type
+    >
+{
+    typedef sell<V, C, Col, Ptr> matrix;
+
+    static void apply(
+            Vector1 const &rhs,
+            matrix  const &A,
+            Vector2 const &x,
+            Vector3       &res
+            )
+    {
+        typedef typename value_type<Vector3>::type T;
+
+        if (!A.is_sell()) {
+            backend::residual(rhs, *A.A, x, res);
+            return;
+        }
+
+        const ptrdiff_t n = A.nrows;
+        const ptrdiff_t m = A.nchunks;
+
+#pragma omp parallel for
+        for(ptrdiff_t c = 0; c < m; ++c) {
+            T sum[C];
+            for(int l = 0; l < C; ++l) sum[l] = math::zero<T>();
+
+            const Col *col = A.col.data() + A.chunk_ptr[c];
+            const V   *val = A.val.data() + A.chunk_ptr[c];
+            const Col *end = A.col.data() + A.chunk_ptr[c+1];
+
+            for(; col < end; col += C, val += C)
+                for(int l = 0; l < C; ++l)
+                    math::mul_add(val[l], x[col[l]], sum[l]);
+
+            for(int l = 0, s = c * C; l < C && s < n; ++l, ++s) {
+                ptrdiff_t i = A.perm[s];
+                res[i] = rhs[i] - sum[l];
+            }
+        }
+    }
+};
+
+} // namespace backend
+} // namespace amgcl
+
+#endif
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include <type_traits>
 #include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/numa_layout.hpp>
 #include <amgcl/value_type/interface.hpp>
 
 namespace amgcl {
@@ -61,22 +62,33 @@ struct spmv_impl<
         typedef typename value_type<Vector2>::type V;
 
         const ptrdiff_t n = static_cast<ptrdiff_t>( rows(A) );
+        const numa_partition *part = detail::row_partition(A);
 
         if (!math::is_zero(beta)) {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < n; ++i) {
-                V sum = math::zero<V>();
-                for(typename row_iterator<Matrix>::type a = row_begin(A, i); a; ++a)
-                    sum += a.value() * x[ a.col() ];
-                y[i] = alpha * sum + beta * y[i];
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    V sum = math::zero<V>();
+                    for(typename row_iterator<Matrix>::type a = row_begin(A, i); a; ++a)
+                        math::mul_add(a.value(), x[ a.col() ], sum);
+                    y[i] = alpha * sum + beta * y[i];
+                }
             }
         } else {
-#pragma omp parallel for
-            for(ptrdiff_t i = 0; i < n; ++i) {
-                V sum = math::zero<V>();
-                for(typename row_iterator<Matrix>::type a = row_begin(A, i); a; ++a)
-                    sum += a.value() * x[ a.col() ];
-                y[i] = alpha * sum;
+#pragma omp parallel
+            {
+                ptrdiff_t beg, end;
+                detail::thread_rows(part, n, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    V sum = math::zero<V>();
+                    for(typename row_iterator<Matrix>::type a = row_begin(A, i); a; ++a)
+                        math::mul_add(a.value(), x[ a.col() ], sum);
+                    y[i] = alpha * sum;
+                }
             }
         }
     }
@@ -103,13 +115,19 @@ struct residual_impl<
         typedef typename value_type<Vector3>::type V;
 
         const ptrdiff_t n = static_cast<ptrdiff_t>( rows(A) );
+        const numa_partition *part = detail::row_partition(A);
 
-#pragma omp parallel for
-        for(ptrdiff_t i = 0; i < n; ++i) {
-            V sum = math::zero<V>();
-            for(typename row_iterator<Matrix>::type a = row_begin(A, i); a; ++a)
-                sum += a.value() * x[ a.col() ];
-            res[i] = rhs[i] - sum;
+#pragma omp parallel
+        {
+            ptrdiff_t beg, end;
+            detail::thread_rows(part, n, beg, end);
+
+            for(ptrdiff_t i = beg; i < end; ++i) {
+                V sum = math::zero<V>();
+                for(typename row_iterator<Matrix>::type a = row_begin(A, i); a; ++a)
+                    math::mul_add(a.value(), x[ a.col() ], sum);
+                res[i] = rhs[i] - sum;
+            }
         }
     }
 };
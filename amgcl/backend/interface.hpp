@@ -32,6 +32,7 @@ THE SOFTWARE.
  */
 
 #include <cmath>
+#include <memory>
 
 #include <type_traits>
 
@@ -79,6 +80,27 @@ struct value_type {
     typedef typename T::value_type type;
 };
 
+/// Metafunction that returns value type of the backend vectors.
+/**
+ * This is the RHS type corresponding to the backend value type, unless the
+ * backend specifies otherwise.
+ */
+template <class Backend, class Enable = void>
+struct vector_value_type {
+    typedef typename math::rhs_of<typename Backend::value_type>::type type;
+};
+
+/// Metafunction that returns the single precision variant of the backend.
+/**
+ * Used for the coarse levels of a mixed precision AMG hierarchy (see
+ * amgcl::amg::params::full_precision_levels). The backend itself is used
+ * unless the backend specifies otherwise.
+ */
+template <class Backend, class Enable = void>
+struct single_precision {
+    typedef Backend type;
+};
+
 /// Implementation for function returning the number of rows in a matrix.
 /** \note Used in rows() */
 template <class Matrix, class Enable = void>
@@ -386,6 +408,62 @@ void vmul(Alpha alpha, const Vector1 &x, const Vector2 &y, Beta beta, Vector3 &z
     AMGCL_TOC("vmul");
 }
 
+/// Data for residual_restrict() precomputed on each level of a hierarchy.
+/**
+ * The default implementation of residual_restrict() needs nothing besides
+ * the restriction operator. Backends that specialize residual_restrict_impl
+ * may keep here what the fused operation needs (e.g. the transpose of R).
+ */
+template <class Backend, class Enable = void>
+struct restriction_plan {
+    struct type {};
+
+    static std::shared_ptr<type> create(
+            const typename Backend::matrix&, const typename Backend::matrix&,
+            const typename Backend::params&)
+    {
+        return std::shared_ptr<type>();
+    }
+};
+
+/// Implementation for fused residual computation and restriction.
+/**
+ * The default implementation stores the residual in the temporary vector and
+ * then restricts it. Backends may specialize this to avoid the extra pass
+ * over the fine-level residual.
+ *
+ * \note Used in residual_restrict()
+ */
+template <class MatrixA, class MatrixR, class Plan, class Vector1, class Vector2, class Vector3, class Vector4, class Enable = void>
+struct residual_restrict_impl {
+    static void apply(
+            const Vector1 &rhs, const MatrixA &A, const Vector2 &x,
+            const MatrixR &R, const Plan*, Vector3 &t, Vector4 &f)
+    {
+        typedef typename math::scalar_of<typename value_type<Vector4>::type>::type scalar;
+
+        residual(rhs, A, x, t);
+        spmv(math::identity<scalar>(), R, t, math::zero<scalar>(), f);
+    }
+};
+
+/// Computes restricted residual error.
+/**
+ * \f[f = R (rhs - Ax).\f]
+ * The plan is created with restriction_plan<Backend>::create(A, R, prm), and
+ * may be empty. The vector t is used as a temporary storage for the
+ * fine-level residual and its contents are undefined on exit.
+ */
+template <class MatrixA, class MatrixR, class Plan, class Vector1, class Vector2, class Vector3, class Vector4>
+void residual_restrict(
+        const Vector1 &rhs, const MatrixA &A, const Vector2 &x,
+        const MatrixR &R, const Plan *plan, Vector3 &t, Vector4 &f)
+{
+    AMGCL_TIC("residual_restrict");
+    residual_restrict_impl<MatrixA, MatrixR, Plan, Vector1, Vector2, Vector3, Vector4>::apply(rhs, A, x, R, plan, t, f);
+    AMGCL_TOC("residual_restrict");
+}
+
 /// Is the relaxation supported by the backend?
 template <class Backend, template <class> class Relaxation, class Enable = void>
 struct relaxation_is_supported : std::true_type {};
@@ -0,0 +1,175 @@
+#ifndef AMGCL_BACKEND_NUMA_LAYOUT_HPP
+#define AMGCL_BACKEND_NUMA_LAYOUT_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * \file   amgcl/backend/numa_layout.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Thread to row mapping for the NUMA mode of the builtin backend.
+ */
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+namespace amgcl {
+namespace backend {
+
+/// Boundaries of the row blocks owned by each of the threads.
+typedef std::vector<ptrdiff_t> numa_partition;
+
+/// Thread to row mapping shared by the matrices and vectors of a hierarchy.
+/**
+ * In the NUMA mode (see amgcl::backend::builtin_params::numa) the rows of
+ * each matrix are split into contiguous blocks, one per thread, with about
+ * the same number of nonzeros in each block. The matrix data and the vectors
+ * of the same size are first touched by the thread owning the rows, so that
+ * the memory pages end up on the socket of that thread, and every matrix and
+ * vector operation later uses the same mapping. This only makes sense when
+ * the threads are pinned to the cores (e.g. with ``OMP_PROC_BIND=true``),
+ * and the number of threads does not change between setup and solution.
+ *
+ * The first matrix or vector with a given number of rows fixes the partition
+ * for the size, so that, for example, the restriction operator of a level
+ * and the work vectors and the system matrix of the next coarser level share
+ * the same mapping. The object is thread-safe.
+ */
+class numa_layout {
+    public:
+        /// Partition for a vector of size n.
+        std::shared_ptr<const numa_partition> rows(size_t n) {
+            std::lock_guard<std::mutex> lock(mx);
+
+            auto &p = known[n];
+            if (!p) p = std::make_shared<numa_partition>(balance(n, static_cast<const ptrdiff_t*>(0)));
+            return p;
+        }
+
+        /// Partition for a matrix with n rows and the given row pointer array.
+        /**
+         * Square and rectangular matrices alike reuse the partition of their
+         * row space if it is known, and fix it otherwise.
+         */
+        template <class Ptr>
+        std::shared_ptr<const numa_partition> rows(size_t n, const Ptr *ptr) {
+            std::lock_guard<std::mutex> lock(mx);
+
+            auto &p = known[n];
+            if (!p) p = std::make_shared<numa_partition>(balance(n, ptr));
+            return p;
+        }
+    private:
+        std::mutex mx;
+        std::map<size_t, std::shared_ptr<const numa_partition>> known;
+
+        // Splits the rows so that each thread gets about the same share of
+        // rows plus nonzeros.
+        template <class Ptr>
+        static numa_partition balance(size_t n, const Ptr *ptr) {
+#ifdef _OPENMP
+            const int nt = omp_get_max_threads();
+#else
+            const int nt = 1;
+#endif
+            const ptrdiff_t nrows = n;
+            const ptrdiff_t total = nrows + (ptr ? ptr[n] - ptr[0] : 0);
+
+            numa_partition p(nt + 1, nrows);
+            p[0] = 0;
+
+            for(int t = 1; t < nt; ++t) {
+                const ptrdiff_t target = total * t / nt;
+
+                ptrdiff_t lo = p[t-1], hi = nrows;
+                while(lo < hi) {
+                    ptrdiff_t mid = lo + (hi - lo) / 2;
+                    ptrdiff_t w = mid + (ptr ? ptr[mid] - ptr[0] : 0);
+                    if (w < target) lo = mid + 1; else hi = mid;
+                }
+
+                p[t] = lo;
+            }
+
+            return p;
+        }
+};
+
+namespace detail {
+
+/// Rows owned by the thread tid of a team of nt threads.
+/**
+ * When the partition is not set, or was made for a team of a different size,
+ * the rows are split into equal blocks.
+ */
+inline void thread_rows(const numa_partition *part, ptrdiff_t n,
+        int nt, int tid, ptrdiff_t &beg, ptrdiff_t &end)
+{
+    if (part && static_cast<int>(part->size()) == nt + 1 && part->back() == n) {
+        beg = (*part)[tid];
+        end = (*part)[tid + 1];
+    } else {
+        const ptrdiff_t chunk = n / nt, extra = n % nt;
+        beg = tid * chunk + std::min<ptrdiff_t>(tid, extra);
+        end = beg + chunk + (tid < extra);
+    }
+}
+
+/// Rows owned by the calling thread of the current parallel region.
+inline void thread_rows(const numa_partition *part, ptrdiff_t n,
+        ptrdiff_t &beg, ptrdiff_t &end)
+{
+#ifdef _OPENMP
+    thread_rows(part, n, omp_get_num_threads(), omp_get_thread_num(), beg, end);
+#else
+    thread_rows(part, n, 1, 0, beg, end);
+#endif
+}
+
+/// Row partition of a matrix or a vector (if any).
+template <class T, class Enable = void>
+struct row_partition_impl {
+    static const numa_partition* get(const T&) {
+        return 0;
+    }
+};
+
+template <class T>
+const numa_partition* row_partition(const T &t) {
+    return row_partition_impl<T>::get(t);
+}
+
+} // namespace detail
+} // namespace backend
+} // namespace amgcl
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef AMGCL_BACKEND_WORKSPACE_HPP
+#define AMGCL_BACKEND_WORKSPACE_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/backend/workspace.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Pool of work vectors shared between solvers.
+ */
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <utility>
+
+#include <amgcl/backend/interface.hpp>
+
+namespace amgcl {
+namespace backend {
+
+/// Pool of work vectors shared between solvers and preconditioners.
+/**
+ * The iterative solvers and the AMG hierarchy normally allocate their work
+ * vectors at construction, and keep them for their lifetime. When the
+ * backend parameters hold a workspace, the vectors are instead borrowed from
+ * the workspace for the duration of a solve, and are returned to it
+ * afterwards. Several solvers sharing the same workspace then only use as
+ * much memory for work vectors as the ones running concurrently need.
+ *
+ * The vectors are pooled by type and size. The workspace is thread-safe.
+ */
+class workspace : public std::enable_shared_from_this<workspace> {
+    public:
+        workspace() : total(0) {}
+
+        /// Returns a vector of size n, creating it with create() if necessary.
+        /**
+         * The vector is returned to the workspace when the last copy of the
+         * returned pointer is destroyed. The contents of the vector are
+         * undefined.
+         */
+        template <class Vector, class Create>
+        std::shared_ptr<Vector> acquire(size_t n, Create &&create) {
+            const key_type key(std::type_index(typeid(Vector)), n);
+
+            std::shared_ptr<Vector> v;
+            {
+                std::lock_guard<std::mutex> lock(mx);
+                auto i = pool.find(key);
+                if (i != pool.end()) {
+                    v = std::static_pointer_cast<Vector>(i->second);
+                    pool.erase(i);
+                }
+            }
+
+            if (!v) {
+                v = create();
+
+                std::lock_guard<std::mutex> lock(mx);
+                total += backend::bytes(*v);
+            }
+
+            std::weak_ptr<workspace> self = shared_from_this();
+
+            return std::shared_ptr<Vector>(v.get(), [self, key, v](Vector*) {
+                    if (auto w = self.lock()) w->release(key, v);
+                    });
+        }
+
+        /// Releases the pooled vectors that are not in use.
+        void clear() {
+            std::lock_guard<std::mutex> lock(mx);
+            pool.clear();
+        }
+
+        /// Total size of the vectors created by the workspace.
+        size_t bytes() const {
+            return total;
+        }
+    private:
+        typedef std::pair<std::type_index, size_t> key_type;
+
+        std::mutex mx;
+        std::multimap< key_type, std::shared_ptr<void> > pool;
+        size_t total;
+
+        void release(const key_type &key, std::shared_ptr<void> v) {
+            std::lock_guard<std::mutex> lock(mx);
+            pool.insert(std::make_pair(key, std::move(v)));
+        }
+};
+
+namespace detail {
+
+template <class Params>
+auto params_workspace(const Params &prm, int) -> decltype(prm.scratch) {
+    return prm.scratch;
+}
+
+template <class Params>
+std::shared_ptr<workspace> params_workspace(const Params&, long) {
+    return std::shared_ptr<workspace>();
+}
+
+} // namespace detail
+
+/// A set of work vectors of the same size.
+/**
+ * When the backend parameters provide a workspace (as the ``scratch`` field),
+ * the vectors are borrowed from it on each call to get(). Otherwise they
+ * are allocated once at construction.
+ */
+template <class Backend>
+class work_vectors {
+    public:
+        typedef typename Backend::vector vector;
+        typedef typename Backend::params backend_params;
+
+        typedef std::vector< std::shared_ptr<vector> > vector_set;
+
+        work_vectors() : m(0), n(0) {}
+
+        work_vectors(size_t m, size_t n, const backend_params &prm)
+            : m(m), n(n), prm(prm), ws(detail::params_workspace(prm, 0))
+        {
+            if (!ws) {
+                own.reserve(m);
+                for(size_t i = 0; i < m; ++i)
+                    own.push_back(Backend::create_vector(n, prm));
+            }
+        }
+
+        /// Returns the work vectors.
+        /**
+         * Borrowed vectors stay reserved until the returned pointers are
+         * destroyed.
+         */
+        vector_set get() const {
+            if (!ws) return own;
+
+            vector_set v;
+            v.reserve(m);
+            for(size_t i = 0; i < m; ++i)
+                v.push_back(ws->acquire<vector>(n, [this]() {
+                            return Backend::create_vector(n, prm);
+                            }));
+            return v;
+        }
+
+        /// Memory owned by the set (borrowed vectors are not counted).
+        size_t bytes() const {
+            size_t b = 0;
+            for(const auto &v : own) b += backend::bytes(*v);
+            return b;
+        }
+    private:
+        size_t m, n;
+        backend_params prm;
+        std::shared_ptr<workspace> ws;
+        vector_set own;
+};
+
+} // namespace backend
+} // namespace amgcl
+
+#endif
@@ -159,6 +159,20 @@ struct aggregation {
     coarse_operator(const Matrix &A, const Matrix &P, const Matrix &R) const {
         return detail::scaled_galerkin(A, P, R, 1 / prm.over_interp);
     }
+
+    /// Creates system matrix for the coarser level reusing the product structure.
+    /**
+     * The plan is filled on the first call, and allows subsequent calls for
+     * matrices with the same sparsity patterns to skip the symbolic part of
+     * the Galerkin product.
+     */
+    template <class Matrix>
+    std::shared_ptr<Matrix>
+    coarse_operator(const Matrix &A, const Matrix &P, const Matrix &R,
+            detail::galerkin_plan<Matrix> &plan) const
+    {
+        return detail::scaled_galerkin(A, P, R, 1 / prm.over_interp, plan);
+    }
 };
 
 } // namespace coarsening
@@ -38,6 +38,15 @@ namespace amgcl {
 namespace coarsening {
 namespace detail {
 
+// The fused triple product recomputes a row of A * P for each nonzero in the
+// corresponding column of R. It is used when R has few nonzeros per column
+// (which is the case e.g. for non-smoothed aggregation), so that the
+// redundant work is outweighed by not having to store A * P.
+template <class Matrix>
+bool use_fused_rap(const Matrix &R) {
+    return backend::nonzeros(R) <= 2 * backend::cols(R);
+}
+
 template <class Matrix>
 std::shared_ptr<Matrix> galerkin(
         const Matrix &A, const Matrix &P, const Matrix &R
@@ -46,6 +55,49 @@ std::shared_ptr<Matrix> galerkin(
     return product(R, *product(A, P));
 }
 
+template <class V, class C, class P>
+std::shared_ptr< backend::crs<V, C, P> > galerkin(
+        const backend::crs<V, C, P> &A,
+        const backend::crs<V, C, P> &Pr,
+        const backend::crs<V, C, P> &R
+        )
+{
+    if (use_fused_rap(R))
+        return product(R, A, Pr);
+    else
+        return product(R, *product(A, Pr));
+}
+
+/// Sparsity patterns of the products in the Galerkin operator.
+/**
+ * Allows to only do the numeric part of the products when the coarse
+ * operator is recomputed for a matrix with unchanged sparsity pattern.
+ */
+template <class Matrix>
+struct galerkin_plan {
+    typedef typename Matrix::col_type col_type;
+    typedef typename Matrix::ptr_type ptr_type;
+
+    backend::product_plan<col_type, ptr_type> AP;
+    backend::product_plan<col_type, ptr_type> RAP;
+
+    size_t bytes() const {
+        return AP.bytes() + RAP.bytes();
+    }
+};
+
+template <class Matrix>
+std::shared_ptr<Matrix> galerkin(
+        const Matrix &A, const Matrix &P, const Matrix &R,
+        galerkin_plan<Matrix> &plan
+        )
+{
+    if (use_fused_rap(R))
+        return product(R, A, P, plan.RAP);
+    else
+        return product(R, *product(A, P, plan.AP), plan.RAP);
+}
+
 } // namespace detail
 } // namespace coarsening
 } // namespace amgcl
@@ -50,6 +50,20 @@ std::shared_ptr<Matrix> scaled_galerkin(
         return a;
 }
 
+template <class Matrix>
+std::shared_ptr<Matrix> scaled_galerkin(
+        const Matrix &A,
+        const Matrix &P,
+        const Matrix &R,
+        float s,
+        galerkin_plan<Matrix> &plan
+        )
+{
+        auto a = galerkin(A, P, R, plan);
+        scale(*a, s);
+        return a;
+}
+
 } // namespace detail
 } // namespace coarsening
 } // namespace amgcl
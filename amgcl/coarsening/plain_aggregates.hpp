@@ -33,6 +33,11 @@ THE SOFTWARE.
 
 #include <vector>
 #include <numeric>
+#include <cstdint>
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 
 #include <amgcl/util.hpp>
 #include <amgcl/backend/builtin.hpp>
@@ -58,6 +63,16 @@ namespace coarsening {
  * beloning to this aggregate. Later they may be claimed by other aggregates;
  * if nobody claims them, then they just stay in their initial aggregate.
  *
+ * The greedy pass is sequential. When params::parallel is set, the
+ * aggregates are instead built around the nodes of a distance-2 maximal
+ * independent set (MIS-2) of the strong connectivity graph, which is found in
+ * parallel (see Bell, Dalton, Olson, "Exposing fine-grained parallelism in
+ * algebraic multigrid methods", SISC 34(4), 2012). Each node of the set
+ * becomes the root of an aggregate, its strong neighbours join the
+ * aggregate, and the rest of the nodes join an aggregate of one of their
+ * strong neighbours. The aggregates are similar in size to the ones produced
+ * by the greedy pass.
+ *
  * \ingroup aggregates
  */
 struct plain_aggregates {
@@ -72,17 +87,22 @@ struct plain_aggregates {
          */
         float eps_strong;
 
-        params() : eps_strong(0.08f) {}
+        /// Use the parallel (MIS-2 based) aggregation algorithm.
+        bool parallel;
+
+        params() : eps_strong(0.08f), parallel(false) {}
 
 #ifndef AMGCL_NO_BOOST
         params(const boost::property_tree::ptree &p)
-            : AMGCL_PARAMS_IMPORT_VALUE(p, eps_strong)
+            : AMGCL_PARAMS_IMPORT_VALUE(p, eps_strong),
+              AMGCL_PARAMS_IMPORT_VALUE(p, parallel)
         {
-            check_params(p, {"eps_strong", "block_size"});
+            check_params(p, {"eps_strong", "parallel", "block_size"});
         }
 
         void get(boost::property_tree::ptree &p, const std::string &path) const {
             AMGCL_PARAMS_EXPORT_VALUE(p, path, eps_strong);
+            AMGCL_PARAMS_EXPORT_VALUE(p, path, parallel);
         }
 #endif
     };
@@ -140,10 +160,9 @@ struct plain_aggregates {
         /* 2. Get aggregate ids */
 
         // Remove lonely nodes.
-        size_t max_neib = 0;
-        for(size_t i = 0; i < n; ++i) {
+#pragma omp parallel for
+        for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
             ptrdiff_t j = A.ptr[i], e = A.ptr[i+1];
-            max_neib    = std::max<size_t>(max_neib, e - j);
 
             ptrdiff_t state = removed;
             for(; j < e; ++j)
@@ -155,6 +174,15 @@ struct plain_aggregates {
             id[i] = state;
         }
 
+        if (prm.parallel) {
+            mis2_aggregates(A);
+            return;
+        }
+
+        size_t max_neib = 0;
+        for(size_t i = 0; i < n; ++i)
+            max_neib = std::max<size_t>(max_neib, A.ptr[i+1] - A.ptr[i]);
+
         std::vector<ptrdiff_t> neib;
         neib.reserve(max_neib);
 
@@ -205,6 +233,175 @@ struct plain_aggregates {
                 if (id[i] >= 0) id[i] = cnt[id[i]] - 1;
         }
     }
+
+    private:
+        // State of a node in the MIS-2 search, packed into a single key: the
+        // two upper bits hold the state, and the rest is a random (but
+        // reproducible) priority, which is unique for each node. The maximum
+        // of the keys over a neighbourhood tells if there is a selected node
+        // in the neighbourhood, or if the node itself has the highest
+        // priority among the undecided ones.
+        typedef uint64_t mis_key;
+
+        enum { excluded = 0, undecided = 1, selected = 2 };
+
+        static const int     state_shift = 62;
+        static const mis_key rank_mask   = (static_cast<mis_key>(1) << state_shift) - 1;
+
+        static int mis_state(mis_key k) {
+            return static_cast<int>(k >> state_shift);
+        }
+
+        static mis_key mis_set_state(mis_key k, int state) {
+            return (k & rank_mask) | (static_cast<mis_key>(state) << state_shift);
+        }
+
+        // A bijective hash on [0, 2^62), so that the priorities are unique.
+        static mis_key mis_rank(ptrdiff_t i) {
+            mis_key h = static_cast<mis_key>(i);
+            h = (h ^ (h >> 31)) * 0x7fb5d329728ea185ULL & rank_mask;
+            h = (h ^ (h >> 27)) * 0x81dadef4bc2dd44dULL & rank_mask;
+            return h ^ (h >> 33);
+        }
+
+        // Maximum of the keys over the (strong) neighbourhood of node i.
+        template <class Matrix>
+        mis_key mis_max(const Matrix &A,
+                const std::vector<mis_key> &s, ptrdiff_t i) const
+        {
+            mis_key m = s[i];
+            for(ptrdiff_t j = A.ptr[i], e = A.ptr[i+1]; j < e; ++j) {
+                mis_key v = strong_connection[j] ? s[A.col[j]] : 0;
+                m = std::max(m, v);
+            }
+            return m;
+        }
+
+        template <class Matrix>
+        void mis2_aggregates(const Matrix &A) {
+            const ptrdiff_t n = backend::rows(A);
+
+            // Find the MIS-2 of the strong connectivity graph: on each round,
+            // the undecided nodes with the highest priority in their
+            // distance-2 neighbourhood are selected, and the undecided nodes
+            // within distance 2 of a selected node are excluded.
+            std::vector<mis_key> s(n), t(n, 0);
+
+            ptrdiff_t n_undecided = 0;
+#pragma omp parallel for reduction(+:n_undecided)
+            for(ptrdiff_t i = 0; i < n; ++i) {
+                if (id[i] == removed) {
+                    s[i] = mis_set_state(mis_rank(i), excluded);
+                } else {
+                    s[i] = mis_set_state(mis_rank(i), undecided);
+                    ++n_undecided;
+                }
+            }
+
+            while(n_undecided) {
+                // Maximum over the distance-1 neighbourhoods. It stays the
+                // same once a selected node is in the neighbourhood.
+#pragma omp parallel for
+                for(ptrdiff_t i = 0; i < n; ++i) {
+                    if (mis_state(t[i]) != selected)
+                        t[i] = mis_max(A, s, i);
+                }
+
+                // Maximum over the distance-2 neighbourhoods of the
+                // undecided nodes.
+                n_undecided = 0;
+#pragma omp parallel for reduction(+:n_undecided)
+                for(ptrdiff_t i = 0; i < n; ++i) {
+                    if (mis_state(s[i]) != undecided) continue;
+
+                    mis_key m = mis_max(A, t, i);
+
+                    if (m == s[i]) {
+                        s[i] = mis_set_state(s[i], selected);
+                    } else if (mis_state(m) == selected) {
+                        s[i] = mis_set_state(s[i], excluded);
+                    } else {
+                        ++n_undecided;
+                    }
+                }
+            }
+
+            // Number the aggregates in the order of their roots.
+            std::vector<ptrdiff_t> start;
+
+#pragma omp parallel
+            {
+#ifdef _OPENMP
+                const int nt  = omp_get_num_threads();
+                const int tid = omp_get_thread_num();
+#else
+                const int nt  = 1;
+                const int tid = 0;
+#endif
+
+#pragma omp single
+                start.resize(nt + 1, 0);
+
+                ptrdiff_t cnt = 0;
+#pragma omp for schedule(static)
+                for(ptrdiff_t i = 0; i < n; ++i)
+                    if (mis_state(s[i]) == selected) ++cnt;
+
+                start[tid + 1] = cnt;
+
+#pragma omp barrier
+#pragma omp single
+                {
+                    std::partial_sum(start.begin(), start.end(), start.begin());
+                    count = start[nt];
+                }
+
+                cnt = start[tid];
+#pragma omp for schedule(static)
+                for(ptrdiff_t i = 0; i < n; ++i)
+                    if (mis_state(s[i]) == selected) id[i] = cnt++;
+            }
+
+            if (!count) throw error::empty_level();
+
+            // The nodes adjacent to a root join its aggregate. The roots are
+            // at least distance 3 apart, so the aggregate is unique (unless
+            // the connectivity is nonsymmetric, in which case any of the
+            // adjacent roots will do).
+            std::vector<ptrdiff_t> root(id);
+
+#pragma omp parallel for
+            for(ptrdiff_t i = 0; i < n; ++i) {
+                if (root[i] != undefined) continue;
+
+                for(ptrdiff_t j = A.ptr[i], e = A.ptr[i+1]; j < e; ++j) {
+                    if (!strong_connection[j]) continue;
+                    ptrdiff_t c = A.col[j];
+                    if (mis_state(s[c]) == selected) {
+                        id[i] = root[c];
+                        break;
+                    }
+                }
+            }
+
+            // The rest of the nodes are within distance 2 of a root, and
+            // join the aggregate of a neighbour assigned on the previous step.
+            root = id;
+
+#pragma omp parallel for
+            for(ptrdiff_t i = 0; i < n; ++i) {
+                if (root[i] != undefined) continue;
+
+                for(ptrdiff_t j = A.ptr[i], e = A.ptr[i+1]; j < e; ++j) {
+                    if (!strong_connection[j]) continue;
+                    ptrdiff_t c = A.col[j];
+                    if (root[c] >= 0) {
+                        id[i] = root[c];
+                        break;
+                    }
+                }
+            }
+        }
 };
 
 } // namespace coarsening
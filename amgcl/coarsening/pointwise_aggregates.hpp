@@ -66,7 +66,7 @@ class pointwise_aggregates {
                 : plain_aggregates::params(p),
                   AMGCL_PARAMS_IMPORT_VALUE(p, block_size)
             {
-                check_params(p, {"eps_strong", "block_size"});
+                check_params(p, {"eps_strong", "parallel", "block_size"});
             }
 
             void get(boost::property_tree::ptree &p, const std::string &path) const {
@@ -28,15 +28,22 @@ THE SOFTWARE.
 /**
  * \file   amgcl/coarsening/ruge_stuben.hpp
  * \author Denis Demidov <dennis.demidov@gmail.com>
- * \brief  Ruge-Stuben coarsening with direct interpolation.
+ * \brief  Ruge-Stuben coarsening.
  */
 
 #include <algorithm>
 #include <numeric>
+#include <iostream>
+#include <stdexcept>
+#include <cstdint>
 
 #include <tuple>
 #include <memory>
 
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
 #include <amgcl/backend/builtin.hpp>
 #include <amgcl/coarsening/detail/scaled_galerkin.hpp>
 #include <amgcl/util.hpp>
@@ -44,8 +51,92 @@ THE SOFTWARE.
 namespace amgcl {
 namespace coarsening {
 
+/// Algorithms for the C/F splitting in ruge_stuben coarsening.
+namespace cf_split {
+
+enum type {
+    classic,    ///< Classical (sequential) first pass of the Ruge-Stuben split.
+    pmis,       ///< Parallel modified independent set.
+    hmis        ///< Classical first pass on each thread's block of rows, then PMIS.
+};
+
+inline std::ostream& operator<<(std::ostream &os, type s) {
+    switch (s) {
+        case classic:
+            return os << "classic";
+        case pmis:
+            return os << "pmis";
+        case hmis:
+            return os << "hmis";
+        default:
+            return os << "???";
+    }
+}
+
+inline std::istream& operator>>(std::istream &in, type &s) {
+    std::string val;
+    in >> val;
+
+    if (val == "classic")
+        s = classic;
+    else if (val == "pmis")
+        s = pmis;
+    else if (val == "hmis")
+        s = hmis;
+    else
+        throw std::invalid_argument("Invalid C/F splitting type. "
+                "Valid choices are: classic, pmis, hmis.");
+
+    return in;
+}
+
+} // namespace cf_split
+
+/// Interpolation schemes for ruge_stuben coarsening.
+namespace interpolation {
+
+enum type {
+    direct,     ///< Direct interpolation.
+    extended_i  ///< Extended+i (distance-two) interpolation.
+};
+
+inline std::ostream& operator<<(std::ostream &os, type s) {
+    switch (s) {
+        case direct:
+            return os << "direct";
+        case extended_i:
+            return os << "extended_i";
+        default:
+            return os << "???";
+    }
+}
+
+inline std::istream& operator>>(std::istream &in, type &s) {
+    std::string val;
+    in >> val;
+
+    if (val == "direct")
+        s = direct;
+    else if (val == "extended_i")
+        s = extended_i;
+    else
+        throw std::invalid_argument("Invalid interpolation type. "
+                "Valid choices are: direct, extended_i.");
+
+    return in;
+}
+
+} // namespace interpolation
+
 /// Classic Ruge-Stuben coarsening with direct interpolation.
 /**
+ * The classical C/F splitting is sequential. The parallel PMIS and HMIS
+ * splittings (De Sterck, Yang, Heys, SIMAX 27(4), 2006) are available as
+ * alternatives. These produce sparser coarse levels, and are usually combined
+ * with the extended+i (distance-two) interpolation (De Sterck et al., NLAA
+ * 15(2-3), 2008), which, unlike the direct interpolation, is able to
+ * interpolate to the F-points that have no strong C-neighbours.
+ *
  * \ingroup coarsening
  * \sa \cite Stuben1999
  */
@@ -77,23 +168,41 @@ struct ruge_stuben {
         bool  do_trunc;
 
         /// Truncation parameter \f$\varepsilon_{tr}\f$.
+        /**
+         * With the extended+i interpolation, the weights that are smaller (in
+         * absolute value) than the largest one in the row by a factor of
+         * \f$\varepsilon_{tr}\f$ are dropped.
+         */
         float eps_trunc;
 
-        params() : eps_strong(0.25f), do_trunc(true), eps_trunc(0.2f) {}
+        /// C/F splitting algorithm.
+        cf_split::type split;
+
+        /// Interpolation scheme.
+        interpolation::type interp;
+
+        params()
+            : eps_strong(0.25f), do_trunc(true), eps_trunc(0.2f),
+              split(cf_split::classic), interp(interpolation::direct)
+        {}
 
 #ifndef AMGCL_NO_BOOST
         params(const boost::property_tree::ptree &p)
             : AMGCL_PARAMS_IMPORT_VALUE(p, eps_strong),
               AMGCL_PARAMS_IMPORT_VALUE(p, do_trunc),
-              AMGCL_PARAMS_IMPORT_VALUE(p, eps_trunc)
+              AMGCL_PARAMS_IMPORT_VALUE(p, eps_trunc),
+              AMGCL_PARAMS_IMPORT_VALUE(p, split),
+              AMGCL_PARAMS_IMPORT_VALUE(p, interp)
         {
-            check_params(p, {"eps_strong", "do_trunc", "eps_trunc"});
+            check_params(p, {"eps_strong", "do_trunc", "eps_trunc", "split", "interp"});
         }
 
         void get(boost::property_tree::ptree &p, const std::string &path) const {
             AMGCL_PARAMS_EXPORT_VALUE(p, path, eps_strong);
             AMGCL_PARAMS_EXPORT_VALUE(p, path, do_trunc);
             AMGCL_PARAMS_EXPORT_VALUE(p, path, eps_trunc);
+            AMGCL_PARAMS_EXPORT_VALUE(p, path, split);
+            AMGCL_PARAMS_EXPORT_VALUE(p, path, interp);
         }
 #endif
     } prm;
@@ -118,7 +227,16 @@ struct ruge_stuben {
 
         AMGCL_TIC("C/F split");
         connect(A, prm.eps_strong, S, cf);
-        cfsplit(A, S, cf);
+        switch (prm.split) {
+            case cf_split::pmis:
+                pmis(A, S, cf);
+                break;
+            case cf_split::hmis:
+                hmis(A, S, cf);
+                break;
+            default:
+                cfsplit(A, S, cf, 0, n);
+        }
         AMGCL_TOC("C/F split");
 
         AMGCL_TIC("interpolation");
@@ -129,6 +247,13 @@ struct ruge_stuben {
 
         if (!nc) throw error::empty_level();
 
+        if (prm.interp == interpolation::extended_i) {
+            auto P = extended_interpolation<Matrix>(A, S, cf, cidx, nc);
+            AMGCL_TOC("interpolation");
+
+            return std::make_tuple(P, transpose(*P));
+        }
+
         auto P = std::make_shared<Matrix>();
         P->set_size(n, nc, true);
 
@@ -253,6 +378,15 @@ struct ruge_stuben {
         return detail::galerkin(A, P, R);
     }
 
+    /// \copydoc amgcl::coarsening::aggregation::coarse_operator
+    template <class Matrix>
+    std::shared_ptr<Matrix>
+    coarse_operator(const Matrix &A, const Matrix &P, const Matrix &R,
+            detail::galerkin_plan<Matrix> &plan) const
+    {
+        return detail::galerkin(A, P, R, plan);
+    }
+
     private:
         //-------------------------------------------------------------------
         // On return S will hold both strong connection matrix (in S.val, which
@@ -290,6 +424,8 @@ struct ruge_stuben {
 
                 if (math::norm(a_min) < eps) {
                     cf[i] = 'F';
+                    for(Ptr j = A.ptr[i], e = A.ptr[i + 1]; j < e; ++j)
+                        S.val[j] = false;
                     continue;
                 }
 
@@ -315,32 +451,43 @@ struct ruge_stuben {
         }
 
         // Split variables into C(oarse) and F(ine) sets.
+        // Only the variables in [beg, end) and the connections between them
+        // are considered.
         template <typename Val, typename Col, typename Ptr>
         static void cfsplit(
                 backend::crs<Val,  Col, Ptr> const &A,
                 backend::crs<char, Col, Ptr> const &S,
-                std::vector<char>                  &cf
+                std::vector<char>                  &cf,
+                ptrdiff_t beg, ptrdiff_t end
                 )
         {
-            const size_t n = rows(A);
+            const size_t n = end - beg;
 
             std::vector<Col> lambda(n);
 
             // Initialize lambdas:
+            Col max_lambda = 0;
             for(size_t i = 0; i < n; ++i) {
                 Col temp = 0;
-                for(Ptr j = S.ptr[i], e = S.ptr[i+1]; j < e; ++j)
-                    temp += ( cf[ S.col[j] ] == 'U' ? 1 : 2 );
+                for(Ptr j = S.ptr[beg + i], e = S.ptr[beg + i + 1]; j < e; ++j) {
+                    Col c = S.col[j];
+                    if (c < beg || c >= end) continue;
+                    temp += ( cf[c] == 'U' ? 1 : 2 );
+                }
                 lambda[i] = temp;
+                max_lambda = std::max(max_lambda, temp);
             }
 
+            // Number of the lambda groups.
+            const size_t m = std::max<size_t>(n, max_lambda + 1);
+
             // Keep track of variable groups with equal lambda values.
             // ptr - start of a group;
             // cnt - size of a group;
             // i2n - variable number;
             // n2i - vaiable position in a group.
-            std::vector<Ptr> ptr(n+1, 0);
-            std::vector<Ptr> cnt(n, 0);
+            std::vector<Ptr> ptr(m+1, 0);
+            std::vector<Ptr> cnt(m, 0);
             std::vector<Ptr> i2n(n);
             std::vector<Ptr> n2i(n);
 
@@ -364,23 +511,23 @@ struct ruge_stuben {
                 Col lam = lambda[i];
 
                 if (lam == 0) {
-                    std::replace(cf.begin(), cf.end(), 'U', 'C');
+                    std::replace(cf.begin() + beg, cf.begin() + end, 'U', 'C');
                     break;
                 }
 
                 // Remove tne variable from its group.
                 --cnt[lam];
 
-                if (cf[i] == 'F') continue;
+                if (cf[beg + i] == 'F') continue;
 
                 // Mark the variable as 'C'.
-                cf[i] = 'C';
+                cf[beg + i] = 'C';
 
                 // Its neighbours from S' become F-variables.
-                for(Ptr j = S.ptr[i], e = S.ptr[i + 1]; j < e; ++j) {
+                for(Ptr j = S.ptr[beg + i], e = S.ptr[beg + i + 1]; j < e; ++j) {
                     Col c = S.col[j];
 
-                    if (cf[c] != 'U') continue;
+                    if (c < beg || c >= end || cf[c] != 'U') continue;
 
                     cf[c] = 'F';
 
@@ -388,10 +535,13 @@ struct ruge_stuben {
                     for(Ptr aj = A.ptr[c], ae = A.ptr[c + 1]; aj < ae; ++aj) {
                         if (!S.val[aj]) continue;
 
-                        Col ac    = A.col[aj];
+                        Col ac = A.col[aj];
+                        if (ac < beg || ac >= end || cf[ac] != 'U') continue;
+
+                        ac -= beg;
                         Col lam_a = lambda[ac];
 
-                        if (cf[ac] != 'U' || static_cast<size_t>(lam_a) + 1 >= n)
+                        if (static_cast<size_t>(lam_a) + 1 >= m)
                             continue;
 
                         Ptr old_pos = n2i[ac];
@@ -411,13 +561,16 @@ struct ruge_stuben {
                 }
 
                 // Decrease lambdas of the newly create C's neighbours.
-                for(Ptr j = A.ptr[i], e = A.ptr[i + 1]; j < e; j++) {
+                for(Ptr j = A.ptr[beg + i], e = A.ptr[beg + i + 1]; j < e; j++) {
                     if (!S.val[j]) continue;
 
-                    Col c   = A.col[j];
+                    Col c = A.col[j];
+                    if (c < beg || c >= end || cf[c] != 'U') continue;
+
+                    c -= beg;
                     Col lam = lambda[c];
 
-                    if (cf[c] != 'U' || lam == 0) continue;
+                    if (lam == 0) continue;
 
                     Ptr old_pos = n2i[c];
                     Ptr new_pos = ptr[lam];
@@ -434,6 +587,333 @@ struct ruge_stuben {
                 }
             }
         }
+
+        // Random (but reproducible) tie-breaking weight of a variable.
+        static uint32_t pmis_rank(ptrdiff_t i) {
+            uint32_t h = static_cast<uint32_t>(i);
+            h = (h ^ 61) ^ (h >> 16);
+            h *= 9;
+            h ^= h >> 4;
+            h *= 0x27d4eb2d;
+            h ^= h >> 15;
+            return h;
+        }
+
+        // Parallel modified independent set C/F splitting.
+        // The measure of a variable is the number of variables strongly
+        // depending on it, with random tie-breaking. Variables that no one
+        // depends on become F-variables. On each round, the undecided
+        // variables with the largest measure among their undecided strong
+        // neighbours (in both directions) become C-variables, and the
+        // undecided variables strongly depending on those become F-variables.
+        // The C-variables already present in cf on input are kept.
+        template <typename Val, typename Col, typename Ptr>
+        static void pmis(
+                backend::crs<Val,  Col, Ptr> const &A,
+                backend::crs<char, Col, Ptr> const &S,
+                std::vector<char>                  &cf
+                )
+        {
+            const ptrdiff_t n = rows(A);
+
+            std::vector<char> next(n);
+
+#pragma omp parallel for
+            for(ptrdiff_t i = 0; i < n; ++i)
+                if (cf[i] == 'U' && S.ptr[i] == S.ptr[i + 1]) cf[i] = 'F';
+
+            for(;;) {
+                // The undecided variables strongly depending on the
+                // C-variables become F-variables.
+                ptrdiff_t n_undone = 0;
+#pragma omp parallel for reduction(+:n_undone)
+                for(ptrdiff_t i = 0; i < n; ++i) {
+                    next[i] = cf[i];
+                    if (cf[i] != 'U') continue;
+
+                    for(Ptr j = A.ptr[i], e = A.ptr[i + 1]; j < e; ++j) {
+                        if (S.val[j] && cf[A.col[j]] == 'C') {
+                            next[i] = 'F';
+                            break;
+                        }
+                    }
+
+                    if (next[i] == 'U') ++n_undone;
+                }
+
+                cf.swap(next);
+
+                if (!n_undone) break;
+
+                // Select the new C-variables.
+#pragma omp parallel for
+                for(ptrdiff_t i = 0; i < n; ++i) {
+                    next[i] = cf[i];
+                    if (cf[i] != 'U') continue;
+
+                    const Ptr      wi = S.ptr[i + 1] - S.ptr[i];
+                    const uint32_t ri = pmis_rank(i);
+
+                    auto wins = [&](ptrdiff_t c) {
+                        if (c == i || cf[c] != 'U') return true;
+
+                        const Ptr      wc = S.ptr[c + 1] - S.ptr[c];
+                        const uint32_t rc = pmis_rank(c);
+
+                        if (wi != wc) return wi > wc;
+                        if (ri != rc) return ri > rc;
+                        return i > c;
+                    };
+
+                    bool top = true;
+
+                    for(Ptr j = A.ptr[i], e = A.ptr[i + 1]; top && j < e; ++j)
+                        if (S.val[j]) top = wins(A.col[j]);
+
+                    for(Ptr j = S.ptr[i], e = S.ptr[i + 1]; top && j < e; ++j)
+                        top = wins(S.col[j]);
+
+                    if (top) next[i] = 'C';
+                }
+
+                cf.swap(next);
+            }
+        }
+
+        // HMIS C/F splitting: the classical first pass is applied
+        // independently to each thread's block of rows, ignoring the
+        // connections across the block boundaries. The C-variables with no
+        // strong connections across the boundaries are kept, and PMIS
+        // completes the splitting starting from them. As with the
+        // distributed HMIS, the result depends on the number of blocks
+        // (threads).
+        template <typename Val, typename Col, typename Ptr>
+        static void hmis(
+                backend::crs<Val,  Col, Ptr> const &A,
+                backend::crs<char, Col, Ptr> const &S,
+                std::vector<char>                  &cf
+                )
+        {
+            const ptrdiff_t n = rows(A);
+
+#pragma omp parallel
+            {
+#ifdef _OPENMP
+                const ptrdiff_t nt  = omp_get_num_threads();
+                const ptrdiff_t tid = omp_get_thread_num();
+#else
+                const ptrdiff_t nt  = 1;
+                const ptrdiff_t tid = 0;
+#endif
+
+                const ptrdiff_t beg = n * tid / nt;
+                const ptrdiff_t end = n * (tid + 1) / nt;
+
+                std::vector<char> cf0(cf.begin() + beg, cf.begin() + end);
+
+                cfsplit(A, S, cf, beg, end);
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    if (cf[i] != 'C') {
+                        cf[i] = cf0[i - beg];
+                        continue;
+                    }
+
+                    bool interior = true;
+
+                    for(Ptr j = A.ptr[i], e = A.ptr[i + 1]; interior && j < e; ++j) {
+                        if (!S.val[j]) continue;
+                        Col c = A.col[j];
+                        interior = (beg <= c && c < end);
+                    }
+
+                    for(Ptr j = S.ptr[i], e = S.ptr[i + 1]; interior && j < e; ++j) {
+                        Col c = S.col[j];
+                        interior = (beg <= c && c < end);
+                    }
+
+                    if (!interior) cf[i] = cf0[i - beg];
+                }
+            }
+
+            pmis(A, S, cf);
+        }
+
+        // Extended+i interpolation. The interpolatory set of an F-variable
+        // i consists of its strong C-neighbours and of the strong
+        // C-neighbours of its strong F-neighbours. The connections to the
+        // strong F-neighbours are distributed among the interpolatory set and
+        // the variable itself; the rest of the connections are lumped to
+        // the diagonal.
+        template <class Matrix, typename Val, typename Col, typename Ptr>
+        std::shared_ptr<Matrix> extended_interpolation(
+                backend::crs<Val,  Col, Ptr> const &A,
+                backend::crs<char, Col, Ptr> const &S,
+                std::vector<char>            const &cf,
+                std::vector<ptrdiff_t>       const &cidx,
+                size_t nc
+                ) const
+        {
+            typedef typename math::scalar_of<Val>::type Scalar;
+
+            const ptrdiff_t n = rows(A);
+
+            static const Scalar eps  = amgcl::detail::eps<Scalar>(1);
+            static const Val    zero = math::zero<Val>();
+
+            auto P = std::make_shared<Matrix>();
+            P->set_size(n, nc, true);
+
+            // Each thread computes the rows of its block into the local
+            // buffers, which are copied to P once the row sizes are known.
+#pragma omp parallel
+            {
+#ifdef _OPENMP
+                const ptrdiff_t nt  = omp_get_num_threads();
+                const ptrdiff_t tid = omp_get_thread_num();
+#else
+                const ptrdiff_t nt  = 1;
+                const ptrdiff_t tid = 0;
+#endif
+                const ptrdiff_t beg = n * tid / nt;
+                const ptrdiff_t end = n * (tid + 1) / nt;
+
+                std::vector<ptrdiff_t> marker(n, -1);
+                std::vector<ptrdiff_t> cols;
+                std::vector<Val>       vals;
+                std::vector<ptrdiff_t> row_cols;
+                std::vector<Val>       row_vals;
+
+                for(ptrdiff_t i = beg; i < end; ++i) {
+                    if (cf[i] == 'C') {
+                        cols.push_back(cidx[i]);
+                        vals.push_back(math::identity<Val>());
+                        P->ptr[i + 1] = 1;
+                        continue;
+                    }
+
+                    // Interpolatory set.
+                    row_cols.clear();
+                    for(Ptr j = A.ptr[i], e = A.ptr[i + 1]; j < e; ++j) {
+                        if (!S.val[j]) continue;
+
+                        ptrdiff_t c = A.col[j];
+
+                        if (cf[c] == 'C') {
+                            if (marker[c] < 0) {
+                                marker[c] = row_cols.size();
+                                row_cols.push_back(c);
+                            }
+                        } else {
+                            for(Ptr jj = A.ptr[c], ee = A.ptr[c + 1]; jj < ee; ++jj) {
+                                ptrdiff_t cc = A.col[jj];
+                                if (S.val[jj] && cf[cc] == 'C' && marker[cc] < 0) {
+                                    marker[cc] = row_cols.size();
+                                    row_cols.push_back(cc);
+                                }
+                            }
+                        }
+                    }
+
+                    row_vals.assign(row_cols.size(), zero);
+
+                    Val dia = zero;
+
+                    for(Ptr j = A.ptr[i], e = A.ptr[i + 1]; j < e; ++j) {
+                        ptrdiff_t c = A.col[j];
+                        Val       v = A.val[j];
+
+                        if (c == i) {
+                            dia += v;
+                        } else if (marker[c] >= 0) {
+                            row_vals[marker[c]] += v;
+                        } else if (S.val[j] && cf[c] == 'F') {
+                            // Distribute the connection among the
+                            // interpolatory set and the variable itself,
+                            // using the entries of row c with the sign
+                            // opposite to its diagonal.
+                            Val dc = zero, sum = zero;
+                            for(Ptr jj = A.ptr[c], ee = A.ptr[c + 1]; jj < ee; ++jj)
+                                if (A.col[jj] == c) dc = A.val[jj];
+
+                            for(Ptr jj = A.ptr[c], ee = A.ptr[c + 1]; jj < ee; ++jj) {
+                                ptrdiff_t cc = A.col[jj];
+                                Val       vv = A.val[jj];
+
+                                if (cc == c || !(vv * dc < zero)) continue;
+                                if (cc == i || marker[cc] >= 0) sum += vv;
+                            }
+
+                            if (math::norm(sum) < eps) {
+                                dia += v;
+                                continue;
+                            }
+
+                            v /= sum;
+
+                            for(Ptr jj = A.ptr[c], ee = A.ptr[c + 1]; jj < ee; ++jj) {
+                                ptrdiff_t cc = A.col[jj];
+                                Val       vv = A.val[jj];
+
+                                if (cc == c || !(vv * dc < zero)) continue;
+
+                                if (cc == i)
+                                    dia += v * vv;
+                                else if (marker[cc] >= 0)
+                                    row_vals[marker[cc]] += v * vv;
+                            }
+                        } else {
+                            dia += v;
+                        }
+                    }
+
+                    for(ptrdiff_t c : row_cols) marker[c] = -1;
+
+                    if (math::norm(dia) < eps) {
+                        P->ptr[i + 1] = 0;
+                        continue;
+                    }
+
+                    Val   sum_all = zero, sum_kept = zero;
+                    Scalar max_w  = 0;
+
+                    for(Val &w : row_vals) {
+                        w = -w / dia;
+                        sum_all += w;
+                        max_w = std::max(max_w, math::norm(w));
+                    }
+
+                    // Truncate small weights, and rescale the rest to keep
+                    // the row sum.
+                    const Scalar min_w = prm.do_trunc ? prm.eps_trunc * max_w : 0;
+
+                    ptrdiff_t head = cols.size();
+                    for(size_t k = 0; k < row_cols.size(); ++k) {
+                        if (math::norm(row_vals[k]) < min_w || math::norm(row_vals[k]) == 0) continue;
+
+                        cols.push_back(cidx[row_cols[k]]);
+                        vals.push_back(row_vals[k]);
+                        sum_kept += row_vals[k];
+                    }
+
+                    if (prm.do_trunc && math::norm(sum_kept) > eps) {
+                        Val scale = sum_all / sum_kept;
+                        for(size_t k = head; k < vals.size(); ++k) vals[k] *= scale;
+                    }
+
+                    P->ptr[i + 1] = cols.size() - head;
+                }
+
+#pragma omp barrier
+#pragma omp single
+                P->set_nonzeros(P->scan_row_sizes());
+
+                std::copy(cols.begin(), cols.end(), P->col + P->ptr[beg]);
+                std::copy(vals.begin(), vals.end(), P->val + P->ptr[beg]);
+            }
+
+            return P;
+        }
 };
 
 } // namespace coarsening
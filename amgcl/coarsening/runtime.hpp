@@ -182,6 +182,29 @@ struct wrapper {
             AMGCL_RUNTIME_COARSENING(smoothed_aggregation);
             AMGCL_RUNTIME_COARSENING(smoothed_aggr_emin);
 
+#undef AMGCL_RUNTIME_COARSENING
+
+            default:
+                throw std::invalid_argument("Unsupported coarsening type");
+        }
+    }
+
+    template <class Matrix>
+    std::shared_ptr<Matrix>
+    coarse_operator(const Matrix &A, const Matrix &P, const Matrix &R,
+            amgcl::coarsening::detail::galerkin_plan<Matrix> &plan) const
+    {
+        switch(c) {
+
+#define AMGCL_RUNTIME_COARSENING(type) \
+            case type: \
+                return make_coarse<amgcl::coarsening::type>(A, P, R, plan)
+
+            AMGCL_RUNTIME_COARSENING(ruge_stuben);
+            AMGCL_RUNTIME_COARSENING(aggregation);
+            AMGCL_RUNTIME_COARSENING(smoothed_aggregation);
+            AMGCL_RUNTIME_COARSENING(smoothed_aggr_emin);
+
 #undef AMGCL_RUNTIME_COARSENING
 
             default:
@@ -265,6 +288,28 @@ struct wrapper {
     make_coarse(const Matrix&, const Matrix&, const Matrix&) const {
         throw std::logic_error("The coarsening is not supported by the backend");
     }
+
+    template <template <class> class Coarsening, class Matrix>
+    typename std::enable_if<
+        backend::coarsening_is_supported<Backend, Coarsening>::value,
+        std::shared_ptr<Matrix>
+    >::type
+    make_coarse(const Matrix &A, const Matrix &P, const Matrix &R,
+            amgcl::coarsening::detail::galerkin_plan<Matrix> &plan) const
+    {
+        return static_cast<Coarsening<Backend>*>(handle)->coarse_operator(A, P, R, plan);
+    }
+
+    template <template <class> class Coarsening, class Matrix>
+    typename std::enable_if<
+        !backend::coarsening_is_supported<Backend, Coarsening>::value,
+        std::shared_ptr<Matrix>
+    >::type
+    make_coarse(const Matrix&, const Matrix&, const Matrix&,
+            amgcl::coarsening::detail::galerkin_plan<Matrix>&) const
+    {
+        throw std::logic_error("The coarsening is not supported by the backend");
+    }
 };
 
 } // namespace coarsening
@@ -173,6 +173,14 @@ struct smoothed_aggr_emin {
         return detail::galerkin(A, P, R);
     }
 
+    template <class Matrix>
+    std::shared_ptr<Matrix>
+    coarse_operator(const Matrix &A, const Matrix &P, const Matrix &R,
+            detail::galerkin_plan<Matrix> &plan) const
+    {
+        return detail::galerkin(A, P, R, plan);
+    }
+
     private:
         template <class AMatrix, typename Val, typename Col, typename Ptr>
         static std::shared_ptr< backend::crs<Val, Col, Ptr> >
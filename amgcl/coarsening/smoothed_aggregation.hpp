@@ -243,6 +243,15 @@ struct smoothed_aggregation {
     coarse_operator(const Matrix &A, const Matrix &P, const Matrix &R) const {
         return detail::galerkin(A, P, R);
     }
+
+    /// \copydoc amgcl::coarsening::aggregation::coarse_operator
+    template <class Matrix>
+    std::shared_ptr<Matrix>
+    coarse_operator(const Matrix &A, const Matrix &P, const Matrix &R,
+            detail::galerkin_plan<Matrix> &plan) const
+    {
+        return detail::galerkin(A, P, R, plan);
+    }
 };
 
 } // namespace coarsening
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include <vector>
 #include <algorithm>
+#include <numeric>
 
 #include <memory>
 
@@ -41,23 +42,6 @@ THE SOFTWARE.
 
 namespace amgcl {
 namespace coarsening {
-namespace detail {
-    struct skip_negative {
-        const std::vector<ptrdiff_t> &key;
-        int block_size;
-
-        skip_negative(const std::vector<ptrdiff_t> &key, int block_size)
-            : key(key), block_size(block_size) { }
-
-        bool operator()(ptrdiff_t i, ptrdiff_t j) const {
-            // Cast to unsigned type to keep negative values at the end
-            return
-                static_cast<size_t>(key[i]) / block_size <
-                static_cast<size_t>(key[j]) / block_size;
-        }
-    };
-} // namespace detail
-
 
 //---------------------------------------------------------------------------
 struct nullspace_params {
@@ -131,60 +115,81 @@ std::shared_ptr<Matrix> tentative_prolongation(
 
     AMGCL_TIC("tentative");
     if (nullspace.cols > 0) {
-        // Sort fine points by aggregate number.
-        // Put points not belonging to any aggregate to the end of the list.
-        std::vector<ptrdiff_t> order(n);
-        for(size_t i = 0; i < n; ++i) order[i] = i;
-        std::stable_sort(order.begin(), order.end(), detail::skip_negative(aggr, block_size));
+        const int       nc = nullspace.cols;
+        const ptrdiff_t nb = naggr / block_size;
+
+        // Sort fine points by aggregate number (keeping the original order
+        // inside each aggregate). Points not belonging to any aggregate are
+        // skipped. aggr_ptr holds the offset of each aggregate in the list.
+        std::vector<ptrdiff_t> aggr_ptr(nb + 1, 0);
+        for(size_t i = 0; i < n; ++i)
+            if (aggr[i] >= 0) ++aggr_ptr[aggr[i] / block_size + 1];
+
+        std::partial_sum(aggr_ptr.begin(), aggr_ptr.end(), aggr_ptr.begin());
+
+        std::vector<ptrdiff_t> order(aggr_ptr[nb]);
+        {
+            std::vector<ptrdiff_t> pos(aggr_ptr.begin(), aggr_ptr.end() - 1);
+            for(size_t i = 0; i < n; ++i)
+                if (aggr[i] >= 0) order[pos[aggr[i] / block_size]++] = i;
+        }
 
         // Precompute the shape of the prolongation operator.
         // Each row contains exactly nullspace.cols non-zero entries.
         // Rows that do not belong to any aggregate are empty.
-        P->set_size(n, nullspace.cols * naggr / block_size);
+        P->set_size(n, nc * nb);
         P->ptr[0] = 0;
 
 #pragma omp parallel for
         for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i)
-            P->ptr[i+1] = aggr[i] < 0 ? 0 : nullspace.cols;
+            P->ptr[i+1] = aggr[i] < 0 ? 0 : nc;
 
         P->scan_row_sizes();
         P->set_nonzeros();
 
         // Compute the tentative prolongation operator and null-space vectors
-        // for the coarser level.
-        std::vector<double> Bnew;
-        Bnew.reserve(naggr * nullspace.cols * nullspace.cols / block_size);
-
-        size_t offset = 0;
-
-        amgcl::detail::QR<double> qr;
-        std::vector<double> Bpart;
-        for(ptrdiff_t i = 0, nb = naggr / block_size; i < nb; ++i) {
-            size_t d = 0;
-            for(size_t j = offset; j < n && aggr[order[j]] / block_size == i; ++j, ++d);
-            Bpart.resize(d * nullspace.cols);
-
-            for(size_t j = offset, jj = 0; jj < d; ++j, ++jj) {
-                ptrdiff_t ib = nullspace.cols * order[j];
-                for(int k = 0; k < nullspace.cols; ++k)
-                    Bpart[jj + d * k] = nullspace.B[ib + k];
-            }
+        // for the coarser level. The aggregates are independent, so each
+        // thread factorizes its share of them with its own QR workspace, and
+        // writes the results directly to their places in P and Bnew.
+        std::vector<double> Bnew(nb * nc * nc);
+
+#pragma omp parallel
+        {
+            amgcl::detail::QR<double> qr;
+            std::vector<double> Bpart;
+
+#pragma omp for
+            for(ptrdiff_t i = 0; i < nb; ++i) {
+                const ptrdiff_t beg = aggr_ptr[i];
+                const int       d   = static_cast<int>(aggr_ptr[i+1] - beg);
+
+                if (d == 0) continue;
+
+                Bpart.resize(d * nc);
+
+                for(int jj = 0; jj < d; ++jj) {
+                    ptrdiff_t ib = nc * order[beg + jj];
+                    for(int k = 0; k < nc; ++k)
+                        Bpart[jj + d * k] = nullspace.B[ib + k];
+                }
 
-            qr.factorize(d, nullspace.cols, &Bpart[0], amgcl::detail::col_major);
+                qr.factorize(d, nc, &Bpart[0], amgcl::detail::col_major);
 
-            for(int ii = 0; ii < nullspace.cols; ++ii)
-                for(int jj = 0; jj < nullspace.cols; ++jj)
-                    Bnew.push_back( qr.R(ii,jj) );
+                double *b = &Bnew[i * nc * nc];
+                for(int ii = 0; ii < nc; ++ii)
+                    for(int jj = 0; jj < nc; ++jj)
+                        *b++ = qr.R(ii,jj);
 
-            for(size_t ii = 0; ii < d; ++ii, ++offset) {
-                ptrdiff_t  *c = &P->col[P->ptr[order[offset]]];
-                value_type *v = &P->val[P->ptr[order[offset]]];
+                for(int ii = 0; ii < d; ++ii) {
+                    ptrdiff_t  *c = &P->col[P->ptr[order[beg + ii]]];
+                    value_type *v = &P->val[P->ptr[order[beg + ii]]];
 
-                for(int jj = 0; jj < nullspace.cols; ++jj) {
-                    c[jj] = i * nullspace.cols + jj;
-                    // TODO: this is just a workaround to make non-scalar value
-                    // types compile. Most probably this won't actually work.
-                    v[jj] = qr.Q(ii,jj) * math::identity<value_type>();
+                    for(int jj = 0; jj < nc; ++jj) {
+                        c[jj] = i * nc + jj;
+                        // TODO: this is just a workaround to make non-scalar value
+                        // types compile. Most probably this won't actually work.
+                        v[jj] = qr.Q(ii,jj) * math::identity<value_type>();
+                    }
                 }
             }
         }
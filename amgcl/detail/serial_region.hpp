@@ -0,0 +1,76 @@
+#ifndef AMGCL_DETAIL_SERIAL_REGION_HPP
+#define AMGCL_DETAIL_SERIAL_REGION_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * \file   amgcl/detail/serial_region.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Scoped switch to single-threaded execution.
+ */
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+namespace amgcl {
+namespace detail {
+
+/// Runs the OpenMP parallel regions started in the scope with one thread.
+/**
+ * The work in the parallel regions of small problems does not pay for the
+ * cost of starting and synchronizing the thread team. The previous number of
+ * threads is restored when the object is destroyed.
+ */
+class serial_region {
+    public:
+        explicit serial_region(bool enable = true) : nt(0) {
+#ifdef _OPENMP
+            if (enable) {
+                nt = omp_get_max_threads();
+                if (nt > 1) omp_set_num_threads(1);
+            }
+#else
+            (void)enable;
+#endif
+        }
+
+        ~serial_region() {
+#ifdef _OPENMP
+            if (nt > 1) omp_set_num_threads(nt);
+#endif
+        }
+    private:
+        int nt;
+
+        serial_region(const serial_region&);
+        serial_region& operator=(const serial_region&);
+};
+
+} // namespace detail
+} // namespace amgcl
+
+#endif
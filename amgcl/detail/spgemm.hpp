@@ -39,6 +39,13 @@ THE SOFTWARE.
  * requires less memory and shows much better scalability than classic one.
  * It is used when number of OpenMP cores is more than 4.
  *
+ * Additionally, spgemm_rap() computes the triple product R * A * P row by
+ * row, without forming the intermediate product A * P.
+ *
+ * All algorithms do a symbolic pass (computing the structure of the product)
+ * followed by a numeric pass. When the sparsity pattern of the product is
+ * already known, spgemm_numeric() may be used to only update the values.
+ *
  * [1] Saad, Yousef. Iterative methods for sparse linear systems. Siam, 2003.
  * [2] Rupp K, Rudolf F, Weinbub J, Morhammer A, Grasser T, Jungel A. Optimized
  *     Sparse Matrix-Matrix Multiplication for Multi-Core CPUs, GPUs, and Xeon
@@ -50,6 +57,7 @@ THE SOFTWARE.
 #include <omp.h>
 #endif
 
+#include <amgcl/util.hpp>
 #include <amgcl/backend/interface.hpp>
 #include <amgcl/value_type/interface.hpp>
 #include <amgcl/detail/sort_row.hpp>
@@ -501,6 +509,209 @@ void spgemm_rmerge(const AMatrix &A, const BMatrix &B, CMatrix &C) {
     }
 }
 
+//---------------------------------------------------------------------------
+// Numeric pass of the matrix-matrix product. C should already hold the
+// sparsity pattern of A * B (e.g. from a previous product of matrices with
+// the same structure); only the values of C are recomputed.
+template <class AMatrix, class BMatrix, class CMatrix>
+void spgemm_numeric(const AMatrix &A, const BMatrix &B, CMatrix &C)
+{
+    typedef typename backend::value_type<CMatrix>::type Val;
+    typedef ptrdiff_t Idx;
+
+    precondition(C.nrows == A.nrows && C.ncols == B.ncols,
+            "Product structure does not match the matrix sizes");
+
+    bool pattern_ok = true;
+
+#pragma omp parallel
+    {
+        std::vector<ptrdiff_t> marker(B.ncols, -1);
+        bool my_ok = true;
+
+#pragma omp for
+        for(Idx ia = 0; ia < static_cast<Idx>(A.nrows); ++ia) {
+            Idx row_beg = C.ptr[ia];
+            Idx row_end = C.ptr[ia+1];
+
+            for(Idx j = row_beg; j < row_end; ++j) {
+                marker[C.col[j]] = j;
+                C.val[j] = math::zero<Val>();
+            }
+
+            for(Idx ja = A.ptr[ia], ea = A.ptr[ia+1]; ja < ea; ++ja) {
+                Idx ca = A.col[ja];
+                Val va = A.val[ja];
+
+                for(Idx jb = B.ptr[ca], eb = B.ptr[ca+1]; jb < eb; ++jb) {
+                    Idx cb = B.col[jb];
+                    Idx jc = marker[cb];
+
+                    if (jc < row_beg) {
+                        my_ok = false;
+                        continue;
+                    }
+
+                    C.val[jc] += va * B.val[jb];
+                }
+            }
+        }
+
+        if (!my_ok) {
+#pragma omp critical
+            pattern_ok = false;
+        }
+    }
+
+    precondition(pattern_ok,
+            "Sparsity pattern of the product has changed");
+}
+
+//---------------------------------------------------------------------------
+// Triple product C = R * A * P. Each row of C is accumulated directly from
+// the rows of A and P, so that the intermediate product A * P is never
+// stored. The rows of A * P are recomputed for each row of R that
+// references them, so the method is efficient when the columns of R have
+// few nonzeros (e.g. for non-smoothed aggregation).
+template <class RMatrix, class AMatrix, class PMatrix, class CMatrix>
+void spgemm_rap(const RMatrix &R, const AMatrix &A, const PMatrix &P,
+        CMatrix &C, bool sort = true)
+{
+    typedef typename backend::value_type<CMatrix>::type Val;
+    typedef ptrdiff_t Idx;
+
+    C.set_size(R.nrows, P.ncols);
+    C.ptr[0] = 0;
+
+#pragma omp parallel
+    {
+        std::vector<ptrdiff_t> marker(P.ncols, -1);
+
+#pragma omp for
+        for(Idx ir = 0; ir < static_cast<Idx>(R.nrows); ++ir) {
+            Idx C_cols = 0;
+            for(Idx jr = R.ptr[ir], er = R.ptr[ir+1]; jr < er; ++jr) {
+                Idx cr = R.col[jr];
+
+                for(Idx ja = A.ptr[cr], ea = A.ptr[cr+1]; ja < ea; ++ja) {
+                    Idx ca = A.col[ja];
+
+                    for(Idx jp = P.ptr[ca], ep = P.ptr[ca+1]; jp < ep; ++jp) {
+                        Idx cp = P.col[jp];
+                        if (marker[cp] != ir) {
+                            marker[cp] = ir;
+                            ++C_cols;
+                        }
+                    }
+                }
+            }
+            C.ptr[ir + 1] = C_cols;
+        }
+    }
+
+    C.set_nonzeros(C.scan_row_sizes());
+
+#pragma omp parallel
+    {
+        std::vector<ptrdiff_t> marker(P.ncols, -1);
+
+#pragma omp for
+        for(Idx ir = 0; ir < static_cast<Idx>(R.nrows); ++ir) {
+            Idx row_beg = C.ptr[ir];
+            Idx row_end = row_beg;
+
+            for(Idx jr = R.ptr[ir], er = R.ptr[ir+1]; jr < er; ++jr) {
+                Idx cr = R.col[jr];
+                Val vr = R.val[jr];
+
+                for(Idx ja = A.ptr[cr], ea = A.ptr[cr+1]; ja < ea; ++ja) {
+                    Idx ca = A.col[ja];
+                    Val va = vr * A.val[ja];
+
+                    for(Idx jp = P.ptr[ca], ep = P.ptr[ca+1]; jp < ep; ++jp) {
+                        Idx cp = P.col[jp];
+                        Val vp = va * P.val[jp];
+
+                        if (marker[cp] < row_beg) {
+                            marker[cp] = row_end;
+                            C.col[row_end] = cp;
+                            C.val[row_end] = vp;
+                            ++row_end;
+                        } else {
+                            C.val[marker[cp]] += vp;
+                        }
+                    }
+                }
+            }
+
+            if (sort) amgcl::detail::sort_row(
+                    C.col + row_beg, C.val + row_beg, row_end - row_beg);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+// Numeric pass of the triple product C = R * A * P. C should already hold
+// the sparsity pattern of the product.
+template <class RMatrix, class AMatrix, class PMatrix, class CMatrix>
+void spgemm_rap_numeric(const RMatrix &R, const AMatrix &A, const PMatrix &P,
+        CMatrix &C)
+{
+    typedef typename backend::value_type<CMatrix>::type Val;
+    typedef ptrdiff_t Idx;
+
+    precondition(C.nrows == R.nrows && C.ncols == P.ncols,
+            "Product structure does not match the matrix sizes");
+
+    bool pattern_ok = true;
+
+#pragma omp parallel
+    {
+        std::vector<ptrdiff_t> marker(P.ncols, -1);
+        bool my_ok = true;
+
+#pragma omp for
+        for(Idx ir = 0; ir < static_cast<Idx>(R.nrows); ++ir) {
+            Idx row_beg = C.ptr[ir];
+            Idx row_end = C.ptr[ir+1];
+
+            for(Idx j = row_beg; j < row_end; ++j) {
+                marker[C.col[j]] = j;
+                C.val[j] = math::zero<Val>();
+            }
+
+            for(Idx jr = R.ptr[ir], er = R.ptr[ir+1]; jr < er; ++jr) {
+                Idx cr = R.col[jr];
+                Val vr = R.val[jr];
+
+                for(Idx ja = A.ptr[cr], ea = A.ptr[cr+1]; ja < ea; ++ja) {
+                    Idx ca = A.col[ja];
+                    Val va = vr * A.val[ja];
+
+                    for(Idx jp = P.ptr[ca], ep = P.ptr[ca+1]; jp < ep; ++jp) {
+                        Idx jc = marker[P.col[jp]];
+
+                        if (jc < row_beg) {
+                            my_ok = false;
+                            continue;
+                        }
+
+                        C.val[jc] += va * P.val[jp];
+                    }
+                }
+            }
+        }
+
+        if (!my_ok) {
+#pragma omp critical
+            pattern_ok = false;
+        }
+    }
+
+    precondition(pattern_ok,
+            "Sparsity pattern of the product has changed");
+}
+
 } // namespace backend
 } // namespace amgcl
 
@@ -34,8 +34,13 @@ THE SOFTWARE.
 #include <vector>
 #include <string>
 #include <fstream>
+#include <memory>
+#include <cstring>
+#include <cstdint>
 
 #include <amgcl/util.hpp>
+#include <amgcl/backend/builtin.hpp>
+#include <amgcl/io/mmap.hpp>
 #include <amgcl/detail/sort_row.hpp>
 
 namespace amgcl {
@@ -121,6 +126,81 @@ void read_crs(
     }
 }
 
+/// Maps CRS matrix in a binary file into memory.
+/**
+ * The returned matrix does not own its data, and points directly into the
+ * mapped file (the same way amgcl::adapter::zero_copy references the user
+ * arrays). The file stays mapped while the matrix is alive. Unsorted rows
+ * are sorted in place; this only touches the (privately mapped) pages of
+ * these rows, and may be skipped completely when the rows are known to be
+ * sorted. The file is expected to be in the format written by the mm2bin
+ * utility: the matrix size as size_t, followed by the ptr, col, and val
+ * arrays.
+ *
+ * \param fname  Name of the file.
+ * \param sorted The rows are known to be sorted by column.
+ * \param hints  Hints for the memory mapping, see amgcl::io::mapped_file.
+ */
+template <typename Val, typename Col = ptrdiff_t, typename Ptr = Col>
+std::shared_ptr< backend::crs<Val, Col, Ptr> >
+map_crs(const std::string &fname, bool sorted = false, unsigned hints = 0)
+{
+    typedef backend::crs<Val, Col, Ptr> matrix;
+
+    auto file = std::make_shared<mapped_file>(fname, hints);
+    char *p = file->data();
+
+    precondition(file->size() >= sizeof(size_t), "Matrix file is truncated");
+
+    size_t n;
+    std::memcpy(&n, p, sizeof(size_t));
+
+    size_t ptr_beg = sizeof(size_t);
+    size_t col_beg = ptr_beg + (n + 1) * sizeof(Ptr);
+
+    precondition(file->size() >= col_beg, "Matrix file is truncated");
+
+    Ptr *ptr = reinterpret_cast<Ptr*>(p + ptr_beg);
+    size_t nnz = ptr[n];
+
+    size_t val_beg = col_beg + nnz * sizeof(Col);
+
+    precondition(file->size() == val_beg + nnz * sizeof(Val),
+            "Matrix file has wrong size");
+    precondition(
+            reinterpret_cast<uintptr_t>(p + ptr_beg) % alignof(Ptr) == 0 &&
+            reinterpret_cast<uintptr_t>(p + col_beg) % alignof(Col) == 0 &&
+            reinterpret_cast<uintptr_t>(p + val_beg) % alignof(Val) == 0,
+            "Matrix data is not aligned in the file");
+
+    std::shared_ptr<matrix> A(new matrix(), [file](matrix *a) { delete a; });
+
+    A->own_data = false;
+    A->nrows    = n;
+    A->ncols    = n;
+    A->nnz      = nnz;
+    A->ptr      = ptr;
+    A->col      = reinterpret_cast<Col*>(p + col_beg);
+    A->val      = reinterpret_cast<Val*>(p + val_beg);
+
+    if (!sorted) {
+#pragma omp parallel for
+        for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
+            Ptr beg = A->ptr[i];
+            Ptr end = A->ptr[i + 1];
+
+            for(Ptr j = beg + 1; j < end; ++j) {
+                if (A->col[j] < A->col[j-1]) {
+                    amgcl::detail::sort_row(A->col + beg, A->val + beg, end - beg);
+                    break;
+                }
+            }
+        }
+    }
+
+    return A;
+}
+
 template <typename SizeT, typename Val>
 void read_dense(const std::string &fname,
         SizeT &n, SizeT &m, std::vector<Val> &v,
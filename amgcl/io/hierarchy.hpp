@@ -0,0 +1,290 @@
+#ifndef AMGCL_IO_HIERARCHY_HPP
+#define AMGCL_IO_HIERARCHY_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * \file   amgcl/io/hierarchy.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Storage of a constructed AMG hierarchy in a binary file.
+ */
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+
+#include <amgcl/backend/builtin.hpp>
+#include <amgcl/io/mmap.hpp>
+#include <amgcl/util.hpp>
+
+namespace amgcl {
+namespace io {
+
+/// AMG hierarchy stored in a file with amgcl::amg::save().
+/**
+ * The file starts with a header holding the format version, the sizes of
+ * the index and value types, and the number of levels. Each level record
+ * holds the level flags, the system matrix, and (unless it is the coarsest
+ * level) the prolongation and the restriction operators. A matrix is stored
+ * as its dimensions followed by the ``ptr``, ``col``, and ``val`` arrays of
+ * the CRS format. All blocks are aligned to 64 bytes, the data is in the
+ * native byte order.
+ *
+ * The file is memory mapped when opened, and the matrices returned by
+ * hierarchy point into the mapped data, so loading involves no parsing or
+ * copying. The processes on a node that load the same file share the
+ * physical memory of the matrices.
+ */
+class hierarchy {
+    public:
+        /// Level flags.
+        enum {
+            single_precision = 1, ///< The level is stored in single precision.
+            transfer         = 2, ///< The level has transfer operators.
+            direct           = 4  ///< The level uses the direct solver.
+        };
+
+        /// Opens the file saved with amgcl::amg::save().
+        explicit hierarchy(const std::string &fname)
+            : file(std::make_shared<mapped_file>(fname))
+        {
+            precondition(file->size() >= sizeof(header),
+                    fname + " is not an amgcl hierarchy");
+            std::memcpy(&head, file->data(), sizeof(header));
+
+            precondition(std::memcmp(head.magic, magic(), 8) == 0,
+                    fname + " is not an amgcl hierarchy");
+            precondition(head.version == format_version,
+                    "Unsupported hierarchy format version");
+            precondition(head.index_size == sizeof(ptrdiff_t),
+                    "Hierarchy was saved with a different index type");
+
+            size_t pos = aligned(sizeof(header));
+            for(uint64_t i = 0; i < head.levels; ++i) {
+                level_info l;
+
+                check(pos + sizeof(uint32_t));
+                std::memcpy(&l.flags, file->data() + pos, sizeof(uint32_t));
+                pos += aligned(sizeof(uint32_t));
+
+                l.A = pos; pos = skip_matrix(pos, l.flags);
+
+                if (l.flags & transfer) {
+                    l.P = pos; pos = skip_matrix(pos, l.flags);
+                    l.R = pos; pos = skip_matrix(pos, l.flags);
+                } else {
+                    l.P = l.R = 0;
+                }
+
+                info.push_back(l);
+            }
+
+            precondition(!info.empty(), "Hierarchy is empty");
+        }
+
+        /// Number of levels.
+        size_t levels() const {
+            return info.size();
+        }
+
+        /// Flags of the i-th level.
+        unsigned flags(size_t i) const {
+            return info[i].flags;
+        }
+
+        /// Number of rows in the system matrix.
+        size_t rows() const {
+            return matrix_header(info[0].A).nrows;
+        }
+
+        /// System matrix of the i-th level.
+        template <class V>
+        std::shared_ptr< backend::crs<V> > A(size_t i) const {
+            return matrix<V>(info[i].A, info[i].flags);
+        }
+
+        /// Prolongation operator of the i-th level.
+        template <class V>
+        std::shared_ptr< backend::crs<V> > P(size_t i) const {
+            return matrix<V>(info[i].P, info[i].flags);
+        }
+
+        /// Restriction operator of the i-th level.
+        template <class V>
+        std::shared_ptr< backend::crs<V> > R(size_t i) const {
+            return matrix<V>(info[i].R, info[i].flags);
+        }
+
+        /// Writes the hierarchy file.
+        class writer {
+            public:
+                writer(const std::string &fname, size_t levels,
+                        size_t value_size, size_t lp_value_size)
+                    : f(fname.c_str(), std::ios::binary)
+                {
+                    precondition(f, "Failed to open " + fname);
+
+                    header h;
+                    std::memset(&h, 0, sizeof(h));
+                    std::memcpy(h.magic, magic(), 8);
+                    h.version       = format_version;
+                    h.index_size    = sizeof(ptrdiff_t);
+                    h.value_size    = static_cast<uint32_t>(value_size);
+                    h.lp_value_size = static_cast<uint32_t>(lp_value_size);
+                    h.levels        = levels;
+
+                    write(&h, sizeof(h));
+                }
+
+                /// Starts a new level.
+                void level(uint32_t flags) {
+                    write(&flags, sizeof(flags));
+                }
+
+                template <class V>
+                void matrix(const backend::crs<V> &A) {
+                    matrix_info m = {A.nrows, A.ncols, A.nnz};
+                    write(&m, sizeof(m));
+                    write(A.ptr, sizeof(ptrdiff_t) * (A.nrows + 1));
+                    write(A.col, sizeof(ptrdiff_t) * A.nnz);
+                    write(A.val, sizeof(V) * A.nnz);
+                }
+
+                ~writer() {
+                    f.close();
+                }
+            private:
+                std::ofstream f;
+
+                // Writes the block padded to the alignment boundary.
+                void write(const void *p, size_t n) {
+                    static const char zeros[alignment] = {0};
+
+                    f.write(static_cast<const char*>(p), n);
+                    f.write(zeros, aligned(n) - n);
+
+                    precondition(f, "File I/O error");
+                }
+        };
+    private:
+        static const uint32_t format_version = 1;
+        static const size_t   alignment      = 64;
+
+        struct header {
+            char     magic[8];
+            uint32_t version;
+            uint32_t index_size;
+            uint32_t value_size;
+            uint32_t lp_value_size;
+            uint64_t levels;
+        };
+
+        struct matrix_info {
+            uint64_t nrows, ncols, nnz;
+        };
+
+        struct level_info {
+            uint32_t flags;
+            size_t A, P, R;
+        };
+
+        std::shared_ptr<mapped_file> file;
+        header head;
+        std::vector<level_info> info;
+
+        static const char* magic() {
+            return "amgclhie";
+        }
+
+        static size_t aligned(size_t n) {
+            return (n + alignment - 1) / alignment * alignment;
+        }
+
+        void check(size_t end) const {
+            precondition(end <= file->size(), "Hierarchy file is truncated");
+        }
+
+        size_t value_size(unsigned flags) const {
+            return (flags & single_precision) ? head.lp_value_size : head.value_size;
+        }
+
+        matrix_info matrix_header(size_t pos) const {
+            matrix_info m;
+            std::memcpy(&m, file->data() + pos, sizeof(m));
+            return m;
+        }
+
+        size_t skip_matrix(size_t pos, unsigned flags) const {
+            check(pos + sizeof(matrix_info));
+            matrix_info m = matrix_header(pos);
+
+            pos += aligned(sizeof(matrix_info));
+            pos += aligned(sizeof(ptrdiff_t) * (m.nrows + 1));
+            pos += aligned(sizeof(ptrdiff_t) * m.nnz);
+            pos += aligned(value_size(flags) * m.nnz);
+
+            check(pos);
+            return pos;
+        }
+
+        // The matrix references the mapped data, and keeps the file mapped
+        // for its lifetime.
+        template <class V>
+        std::shared_ptr< backend::crs<V> > matrix(size_t pos, unsigned flags) const {
+            precondition(sizeof(V) == value_size(flags),
+                    "Hierarchy was saved with a different value type");
+
+            matrix_info m = matrix_header(pos);
+            char *p = file->data() + pos + aligned(sizeof(matrix_info));
+
+            auto f = file;
+            std::shared_ptr< backend::crs<V> > A(new backend::crs<V>(),
+                    [f](backend::crs<V> *a) { delete a; });
+
+            A->own_data = false;
+            A->nrows    = m.nrows;
+            A->ncols    = m.ncols;
+            A->nnz      = m.nnz;
+
+            A->ptr = reinterpret_cast<ptrdiff_t*>(p);
+            p += aligned(sizeof(ptrdiff_t) * (m.nrows + 1));
+
+            A->col = reinterpret_cast<ptrdiff_t*>(p);
+            p += aligned(sizeof(ptrdiff_t) * m.nnz);
+
+            A->val = reinterpret_cast<V*>(p);
+
+            return A;
+        }
+};
+
+} // namespace io
+} // namespace amgcl
+
+#endif
@@ -35,12 +35,32 @@ THE SOFTWARE.
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <locale>
 #include <numeric>
+#include <complex>
+#include <cstdlib>
+#include <cstring>
 
 #include <type_traits>
 #include <tuple>
 
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+#if defined(_WIN32)
+#  include <locale.h>
+#  define AMGCL_MM_STRTOD_L _strtod_l
+#elif defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+#  include <locale.h>
+#  if defined(__APPLE__) || defined(__FreeBSD__)
+#    include <xlocale.h>
+#  endif
+#  define AMGCL_MM_STRTOD_L strtod_l
+#endif
+
 #include <amgcl/util.hpp>
+#include <amgcl/io/mmap.hpp>
 #include <amgcl/backend/interface.hpp>
 #include <amgcl/value_type/interface.hpp>
 #include <amgcl/detail/sort_row.hpp>
@@ -52,8 +72,9 @@ namespace io {
 class mm_reader {
     public:
         /// Open the file by name
-        mm_reader(const std::string &fname) : f(fname.c_str()) {
+        mm_reader(const std::string &fname) : fname(fname), f(fname.c_str()) {
             precondition(f, "Failed to open file \"" + fname + "\"");
+            f.imbue(std::locale::classic());
 
             // Read banner.
             std::string line;
@@ -132,6 +153,11 @@ class mm_reader {
         size_t cols() const { return ncols; }
 
         /// Read sparse matrix from the file.
+        /**
+         * The file is memory mapped and split into line-aligned chunks,
+         * which are parsed by the OpenMP threads in parallel. The CRS arrays
+         * are then assembled in parallel as well.
+         */
         template <typename Idx, typename Val>
         std::tuple<size_t, size_t> operator()(
                 std::vector<Idx> &ptr,
@@ -170,47 +196,107 @@ class mm_reader {
             precondition(row_beg >= 0 && row_end <= n,
                     "Wrong subset of rows is requested");
 
-            ptrdiff_t _nnz = _symmetric ? 2 * nnz : nnz;
+            ptrdiff_t chunk = row_end - row_beg;
 
-            if (row_beg != 0 || row_end != n)
-                _nnz *= 1.2 * (row_end - row_beg) / n;
+            // Parse the entries. Each thread keeps the entries from its
+            // part of the file that fall into the requested rows.
+            mapped_file file(fname);
+            const char *data_beg = file.data() + static_cast<size_t>(f.tellg());
+            const char *data_end = file.data() + file.size();
 
-            std::vector<Idx> _row; _row.reserve(_nnz);
-            std::vector<Idx> _col; _col.reserve(_nnz);
-            std::vector<Val> _val; _val.reserve(_nnz);
+#ifdef _OPENMP
+            const int nt = omp_get_max_threads();
+#else
+            const int nt = 1;
+#endif
 
-            ptrdiff_t chunk = row_end - row_beg;
+            std::vector< std::vector<Idx> > _row(nt), _col(nt);
+            std::vector< std::vector<Val> > _val(nt);
+            std::vector<size_t> _cnt(nt, 0);
+            std::vector<char>   _err(nt, 0);
 
-            ptr.resize(chunk + 1); std::fill(ptr.begin(), ptr.end(), 0);
+#pragma omp parallel
+            {
+#ifdef _OPENMP
+                const int tn  = omp_get_num_threads();
+                const int tid = omp_get_thread_num();
+#else
+                const int tn  = 1;
+                const int tid = 0;
+#endif
+                const char *p = line_start(data_beg, data_end, tid,     tn);
+                const char *e = line_start(data_beg, data_end, tid + 1, tn);
 
-            for(size_t k = 0; k < nnz; ++k) {
-                precondition(std::getline(f, line), format_error("unexpected eof"));
-                is.clear(); is.str(line);
+                std::vector<Idx> &R = _row[tid];
+                std::vector<Idx> &C = _col[tid];
+                std::vector<Val> &V = _val[tid];
+
+                size_t reserve = (_symmetric ? 2 : 1) * nnz / tn;
+                if (row_beg != 0 || row_end != n)
+                    reserve *= 1.2 * (row_end - row_beg) / n;
+
+                R.reserve(reserve);
+                C.reserve(reserve);
+                V.reserve(reserve);
+
+                std::string tail;
+
+                while(p < e) {
+                    const char *eol = static_cast<const char*>(std::memchr(p, '\n', e - p));
+                    const char *q = p, *qe = eol ? eol : e;
+
+                    // The last line may be missing the newline. Copy it,
+                    // so that the parsers do not run past the mapped data.
+                    if (!eol) {
+                        tail.assign(p, e);
+                        q = tail.c_str(); qe = q + tail.size();
+                    }
+
+                    p = eol ? eol + 1 : e;
+
+                    while(q < qe && (*q == ' ' || *q == '\t' || *q == '\r')) ++q;
+                    if (q == qe || *q == '%') continue;
 
-                Idx i, j;
-                Val v;
+                    Idx i, j;
+                    Val v;
 
-                precondition(is >> i >> j, format_error());
+                    if (!parse(q, qe, i) || !parse(q, qe, j) || !parse(q, qe, v)) {
+                        _err[tid] = 1;
+                        break;
+                    }
 
-                i -= 1;
-                j -= 1;
+                    ++_cnt[tid];
 
-                v = read_value<Val>(is);
+                    i -= 1;
+                    j -= 1;
 
-                if (row_beg <= i && i < row_end) {
-                    ++ptr[i - row_beg + 1];
+                    if (row_beg <= i && i < row_end) {
+                        R.push_back(i - row_beg);
+                        C.push_back(j);
+                        V.push_back(v);
+                    }
 
-                    _row.push_back(i - row_beg);
-                    _col.push_back(j);
-                    _val.push_back(v);
+                    if (_symmetric && i != j && row_beg <= j && j < row_end) {
+                        R.push_back(j - row_beg);
+                        C.push_back(i);
+                        V.push_back(v);
+                    }
                 }
+            }
 
-                if (_symmetric && i != j && row_beg <= j && j < row_end) {
-                    ++ptr[j - row_beg + 1];
+            precondition(std::accumulate(_err.begin(), _err.end(), 0) == 0,
+                    format_error());
+            precondition(std::accumulate(_cnt.begin(), _cnt.end(), size_t(0)) == nnz,
+                    format_error("wrong number of entries"));
+
+            // Assemble the matrix.
+            ptr.resize(chunk + 1); std::fill(ptr.begin(), ptr.end(), 0);
 
-                    _row.push_back(j - row_beg);
-                    _col.push_back(i);
-                    _val.push_back(v);
+#pragma omp parallel for
+            for(int t = 0; t < nt; ++t) {
+                for(Idx i : _row[t]) {
+#pragma omp atomic
+                    ++ptr[i + 1];
                 }
             }
 
@@ -219,14 +305,27 @@ class mm_reader {
             col.resize(ptr.back());
             val.resize(ptr.back());
 
-            for(size_t k = 0, e = val.size(); k < e; ++k) {
-                Idx i = _row[k];
-                Idx j = _col[k];
-                Val v = _val[k];
+            // Atomic capture needs OpenMP 3.1.
+#if defined(_OPENMP) && _OPENMP >= 201107
+#pragma omp parallel for
+#endif
+            for(int t = 0; t < nt; ++t) {
+                for(size_t k = 0, e = _row[t].size(); k < e; ++k) {
+                    Idx i = _row[t][k];
+                    Idx head;
+
+#if defined(_OPENMP) && _OPENMP >= 201107
+#pragma omp atomic capture
+#endif
+                    head = ptr[i]++;
+
+                    col[head] = _col[t][k];
+                    val[head] = _val[t][k];
+                }
 
-                Idx head = ptr[i]++;
-                col[head] = j;
-                val[head] = v;
+                std::vector<Idx>().swap(_row[t]);
+                std::vector<Idx>().swap(_col[t]);
+                std::vector<Val>().swap(_val[t]);
             }
 
             std::rotate(ptr.begin(), ptr.end() - 1, ptr.end());
@@ -294,6 +393,7 @@ class mm_reader {
             return std::make_tuple(row_end - row_beg, m);
         }
     private:
+        std::string   fname;
         std::ifstream f;
 
         bool _sparse;
@@ -310,6 +410,144 @@ class mm_reader {
             return err_string;
         }
 
+        // Start of the line that begins the k-th of n chunks of [beg, end).
+        static const char* line_start(const char *beg, const char *end, int k, int n) {
+            if (k == 0) return beg;
+            if (k == n) return end;
+
+            const char *p = beg + (end - beg) * k / n;
+            if (p[-1] == '\n') return p;
+
+            p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            return p ? p + 1 : end;
+        }
+
+        // Parsers for the entries of the sparse matrix. Each parser reads a
+        // number starting at p, and advances p past the number. The number
+        // should end before e.
+        template <typename T>
+        static typename std::enable_if<std::is_integral<T>::value, bool>::type
+        parse(const char *&p, const char *e, T &x) {
+            while(p < e && (*p == ' ' || *p == '\t')) ++p;
+
+            bool neg = false;
+            if (p < e && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+
+            const char *s = p;
+            long long v = 0;
+            for(; p < e && *p >= '0' && *p <= '9'; ++p) v = 10 * v + (*p - '0');
+
+            x = static_cast<T>(neg ? -v : v);
+            return p != s;
+        }
+
+        // The floating point parser does not depend on the C locale (unlike
+        // strtod). Numbers with at most 19 significant digits, a mantissa
+        // below 2^53, and a decimal exponent within [-22, 22] are converted
+        // exactly. The rest is converted with strtod in the C locale where
+        // strtod_l is available, and with a classic locale stream otherwise.
+        template <typename T>
+        static typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+        parse(const char *&p, const char *e, T &x) {
+            static const double pow10[] = {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+                1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+                1e22
+            };
+
+            while(p < e && (*p == ' ' || *p == '\t')) ++p;
+
+            const char *s = p;
+
+            bool neg = false;
+            if (p < e && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+
+            unsigned long long m = 0;
+            int  ndig  = 0, nsig = 0, exp10 = 0;
+            bool exact = true;
+
+            for(bool frac = false; p < e; ++p) {
+                if (*p == '.' && !frac) {
+                    frac = true;
+                    continue;
+                }
+
+                if (*p < '0' || *p > '9') break;
+
+                int d = *p - '0';
+                ++ndig;
+
+                if (nsig == 0 && d == 0) {
+                    // Leading zero.
+                    if (frac) --exp10;
+                } else if (nsig < 19) {
+                    m = 10 * m + d;
+                    ++nsig;
+                    if (frac) --exp10;
+                } else {
+                    if (d) exact = false;
+                    if (!frac) ++exp10;
+                }
+            }
+
+            if (!ndig) return false;
+
+            if (p < e && (*p == 'e' || *p == 'E')) {
+                const char *q = p + 1;
+
+                bool eneg = false;
+                if (q < e && (*q == '-' || *q == '+')) eneg = (*q++ == '-');
+
+                if (q < e && *q >= '0' && *q <= '9') {
+                    int v = 0;
+                    for(; q < e && *q >= '0' && *q <= '9'; ++q)
+                        if (v < 100000) v = 10 * v + (*q - '0');
+
+                    exp10 += eneg ? -v : v;
+                    p = q;
+                }
+            }
+
+            if (exact && m < (1ULL << 53) && -22 <= exp10 && exp10 <= 22
+                    && !std::is_same<T, long double>::value)
+            {
+                double v = static_cast<double>(m);
+                v = (exp10 < 0 ? v / pow10[-exp10] : v * pow10[exp10]);
+                x = static_cast<T>(neg ? -v : v);
+                return true;
+            }
+
+            return convert(s, p, x);
+        }
+
+        template <typename T>
+        static bool convert(const char *s, const char *p, T &x) {
+            std::istringstream is(std::string(s, p));
+            is.imbue(std::locale::classic());
+            return static_cast<bool>(is >> x);
+        }
+
+#ifdef AMGCL_MM_STRTOD_L
+        static bool convert(const char *s, const char *p, double &x) {
+#ifdef _WIN32
+            static const _locale_t c_locale = _create_locale(LC_NUMERIC, "C");
+#else
+            static const locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+#endif
+            char *q;
+            x = AMGCL_MM_STRTOD_L(s, &q, c_locale);
+            return q == p;
+        }
+#endif
+
+        template <typename T>
+        static bool parse(const char *&p, const char *e, std::complex<T> &x) {
+            T re, im;
+            if (!parse(p, e, re) || !parse(p, e, im)) return false;
+            x = std::complex<T>(re, im);
+            return true;
+        }
+
         template <typename T>
         typename std::enable_if<amgcl::is_complex<T>::value, T>::type
         read_value(std::istream &s) {
@@ -424,4 +662,6 @@ void mm_write(const std::string &fname, const Matrix &A) {
 } // namespace amgcl
 
 
+#undef AMGCL_MM_STRTOD_L
+
 #endif
@@ -0,0 +1,137 @@
+#ifndef AMGCL_IO_MMAP_HPP
+#define AMGCL_IO_MMAP_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * \file   amgcl/io/mmap.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Memory mapped files.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  define AMGCL_HAVE_MMAP
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include <amgcl/util.hpp>
+
+namespace amgcl {
+namespace io {
+
+/// File mapped into memory.
+/**
+ * The file is mapped privately (copy-on-write): the pages are shared with
+ * the page cache and with other processes mapping the same file, until they
+ * are written to. On systems without mmap() the file is read into memory.
+ */
+class mapped_file {
+    public:
+        /// Hints for the kernel on the use of the mapped data.
+        enum {
+            populate = 1, ///< Read the whole file in advance (MAP_POPULATE).
+            willneed = 2  ///< Start reading the file asynchronously (MADV_WILLNEED).
+        };
+
+        /// Maps the file. The hints are ignored where not supported.
+        explicit mapped_file(const std::string &fname, unsigned hints = 0)
+            : ptr(0), len(0)
+        {
+#ifdef AMGCL_HAVE_MMAP
+            int fd = ::open(fname.c_str(), O_RDONLY);
+            precondition(fd >= 0, "Failed to open " + fname);
+
+            int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+            if (hints & populate) flags |= MAP_POPULATE;
+#endif
+
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                len = st.st_size;
+                void *p = ::mmap(0, len, PROT_READ | PROT_WRITE, flags, fd, 0);
+                if (p != MAP_FAILED) ptr = static_cast<char*>(p);
+            }
+
+            ::close(fd);
+
+            precondition(ptr, "Failed to map " + fname);
+
+#ifdef MADV_WILLNEED
+            if (hints & willneed) ::madvise(ptr, len, MADV_WILLNEED);
+#endif
+#else
+            (void)hints;
+
+            std::ifstream f(fname.c_str(), std::ios::binary | std::ios::ate);
+            precondition(f, "Failed to open " + fname);
+
+            len = f.tellg();
+            f.seekg(0);
+
+            buf.resize(len);
+            precondition(f.read(buf.data(), len), "File I/O error");
+            ptr = buf.data();
+#endif
+        }
+
+        ~mapped_file() {
+#ifdef AMGCL_HAVE_MMAP
+            if (ptr) ::munmap(ptr, len);
+#endif
+        }
+
+        /// Start of the mapped data.
+        char* data() const {
+            return ptr;
+        }
+
+        /// Size of the file in bytes.
+        size_t size() const {
+            return len;
+        }
+    private:
+        char  *ptr;
+        size_t len;
+#ifndef AMGCL_HAVE_MMAP
+        std::vector<char> buf;
+#endif
+
+        mapped_file(const mapped_file&);
+        mapped_file& operator=(const mapped_file&);
+};
+
+} // namespace io
+} // namespace amgcl
+
+#endif
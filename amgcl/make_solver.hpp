@@ -111,6 +111,34 @@ class make_solver : public amgcl::detail::non_copyable {
             S(backend::rows(*A), prm.solver, bprm)
         {}
 
+        /** Rebuilds the preconditioner for the new system matrix \p A.
+         * The matrix should have the same size and sparsity pattern as the
+         * one used during initialization. The preconditioner has to support
+         * the operation (see amgcl::amg::rebuild()).
+         */
+        template <class Matrix>
+        void rebuild(
+                const Matrix &A,
+                const backend_params &bprm = backend_params()
+                )
+        {
+            precondition(backend::rows(A) == n,
+                    "Matrix size has changed since the initial setup");
+            P.rebuild(A, bprm);
+        }
+
+        // Rebuilds the preconditioner for the new system matrix.
+        // Takes shared pointer to the matrix in internal format.
+        void rebuild(
+                std::shared_ptr<build_matrix> A,
+                const backend_params &bprm = backend_params()
+                )
+        {
+            precondition(backend::rows(*A) == n,
+                    "Matrix size has changed since the initial setup");
+            P.rebuild(A, bprm);
+        }
+
         /** Computes the solution for the given system matrix \p A and the
          * right-hand side \p rhs.  Returns the number of iterations made and
          * the achieved residual as a ``std::tuple``. The solution vector
@@ -60,6 +60,43 @@ struct inner_product {
 
         return sum;
     }
+
+    /// Local part of the inner product.
+    template <class Vec1, class Vec2>
+    typename math::inner_product_impl<
+        typename backend::value_type<Vec1>::type
+        >::return_type
+    local(const Vec1 &x, const Vec2 &y) const {
+        return backend::inner_product(x, y);
+    }
+
+    /// Handle for the pending reduction started with ireduce().
+    struct request {
+        MPI_Request req;
+
+        void wait() {
+            AMGCL_TIC("inner product");
+            MPI_Wait(&req, MPI_STATUS_IGNORE);
+            AMGCL_TOC("inner product");
+        }
+    };
+
+    /// Starts summation of n local inner products in v over the communicator.
+    /**
+     * The values in v are replaced with the global sums after wait() is
+     * called on the returned request. The reduction is done with
+     * MPI_Iallreduce, so that it may be overlapped with local work.
+     */
+    template <class T>
+    request ireduce(T *v, int n) const {
+        typedef typename math::scalar_of<T>::type S;
+
+        const int elems = n * sizeof(T) / sizeof(S);
+
+        request r;
+        MPI_Iallreduce(MPI_IN_PLACE, v, elems, datatype<S>(), MPI_SUM, comm, &r.req);
+        return r;
+    }
 };
 
 } // namespace mpi
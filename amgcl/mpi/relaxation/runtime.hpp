@@ -92,6 +92,7 @@ struct wrapper {
             AMGCL_RELAX_LOCAL_LOCAL(ilut);
             AMGCL_RELAX_LOCAL_LOCAL(spai1);
             AMGCL_RELAX_LOCAL_LOCAL(gauss_seidel);
+            AMGCL_RELAX_LOCAL_LOCAL(multicolor_gauss_seidel);
 
 #undef AMGCL_RELAX_LOCAL_LOCAL
 #undef AMGCL_RELAX_LOCAL_DISTR
@@ -122,6 +123,7 @@ struct wrapper {
             AMGCL_RELAX_LOCAL(spai1);
             AMGCL_RELAX_LOCAL(chebyshev);
             AMGCL_RELAX_LOCAL(gauss_seidel);
+            AMGCL_RELAX_LOCAL(multicolor_gauss_seidel);
 
 #undef AMGCL_RELAX_LOCAL
 #undef AMGCL_RELAX_DISTR
@@ -158,6 +160,7 @@ struct wrapper {
             AMGCL_RELAX_LOCAL_DISTR(spai1);
             AMGCL_RELAX_LOCAL_DISTR(chebyshev);
             AMGCL_RELAX_LOCAL_LOCAL(gauss_seidel);
+            AMGCL_RELAX_LOCAL_LOCAL(multicolor_gauss_seidel);
 
 #undef AMGCL_RELAX_LOCAL_LOCAL
 #undef AMGCL_RELAX_LOCAL_DISTR
@@ -195,6 +198,7 @@ struct wrapper {
             AMGCL_RELAX_LOCAL_DISTR(spai1);
             AMGCL_RELAX_LOCAL_DISTR(chebyshev);
             AMGCL_RELAX_LOCAL_LOCAL(gauss_seidel);
+            AMGCL_RELAX_LOCAL_LOCAL(multicolor_gauss_seidel);
 
 #undef AMGCL_RELAX_LOCAL_LOCAL
 #undef AMGCL_RELAX_LOCAL_DISTR
@@ -227,6 +231,7 @@ struct wrapper {
             AMGCL_RELAX_DISTR(spai0);
             AMGCL_RELAX_LOCAL_DISTR(damped_jacobi);
             AMGCL_RELAX_LOCAL_LOCAL(gauss_seidel);
+            AMGCL_RELAX_LOCAL_LOCAL(multicolor_gauss_seidel);
             AMGCL_RELAX_LOCAL_DISTR(ilu0);
             AMGCL_RELAX_LOCAL_DISTR(iluk);
             AMGCL_RELAX_LOCAL_DISTR(ilut);
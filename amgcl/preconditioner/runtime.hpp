@@ -254,6 +254,38 @@ class preconditioner {
             }
         }
 
+        template <class Matrix>
+        void rebuild(
+                const Matrix &A,
+                const backend_params &bprm = backend_params())
+        {
+            switch(_class) {
+                case precond_class::amg:
+                    {
+                        typedef
+                            amgcl::amg<Backend, runtime::coarsening::wrapper, runtime::relaxation::wrapper>
+                            Precond;
+
+                        static_cast<Precond*>(handle)->rebuild(A, bprm);
+                    }
+                    break;
+                case precond_class::nested:
+                    {
+                        typedef
+                            make_solver<
+                                preconditioner,
+                                runtime::solver::wrapper<Backend>
+                                >
+                            Precond;
+
+                        static_cast<Precond*>(handle)->rebuild(A, bprm);
+                    }
+                    break;
+                default:
+                    throw std::logic_error("Rebuild is not supported by the preconditioner class");
+            }
+        }
+
         std::shared_ptr<matrix> system_matrix_ptr() const {
             switch(_class) {
                 case precond_class::amg:
@@ -42,6 +42,7 @@ THE SOFTWARE.
 #include <vector>
 
 #include <memory>
+#include <type_traits>
 
 #include <amgcl/backend/builtin.hpp>
 #include <amgcl/backend/detail/mixing.hpp>
@@ -49,6 +50,103 @@ THE SOFTWARE.
 
 namespace amgcl {
 namespace preconditioner {
+namespace detail {
+
+// Moves data between the full vector and the flow/pressure subvectors.
+// The generic version uses the permutation matrices x2u, x2p, u2x, p2x.
+template <class Backend, class Enable = void>
+class schur_transfer {
+    public:
+        typedef typename Backend::value_type value_type;
+        typedef typename Backend::matrix     matrix;
+        typedef typename Backend::params     backend_params;
+        typedef typename backend::builtin<value_type>::matrix build_matrix;
+
+        schur_transfer(size_t n, const std::vector<ptrdiff_t> &uidx,
+                const std::vector<ptrdiff_t> &pidx, const backend_params &bprm)
+        {
+            x2u = Backend::copy_matrix(restriction(n, uidx), bprm);
+            x2p = Backend::copy_matrix(restriction(n, pidx), bprm);
+            u2x = Backend::copy_matrix(backend::transpose(*restriction(n, uidx)), bprm);
+            p2x = Backend::copy_matrix(backend::transpose(*restriction(n, pidx)), bprm);
+        }
+
+        template <class Vec1, class Vec2, class Vec3>
+        void gather(const Vec1 &x, Vec2 &u, Vec3 &p) const {
+            backend::spmv(1, *x2u, x, 0, u);
+            backend::spmv(1, *x2p, x, 0, p);
+        }
+
+        template <class Vec1, class Vec2, class Vec3>
+        void scatter(const Vec1 &u, const Vec2 &p, Vec3 &x) const {
+            backend::spmv(1, *u2x, u, 0, x);
+            backend::spmv(1, *p2x, p, 1, x);
+        }
+
+        size_t bytes() const {
+            return backend::bytes(*x2u) + backend::bytes(*x2p)
+                 + backend::bytes(*u2x) + backend::bytes(*p2x);
+        }
+    private:
+        std::shared_ptr<matrix> x2u, x2p, u2x, p2x;
+
+        static std::shared_ptr<build_matrix> restriction(size_t n, const std::vector<ptrdiff_t> &idx) {
+            const size_t m = idx.size();
+            auto R = std::make_shared<build_matrix>();
+            R->set_size(m, n);
+            R->set_nonzeros(m);
+            R->ptr[0] = 0;
+            for(size_t i = 0; i < m; ++i) {
+                R->ptr[i+1] = i + 1;
+                R->col[i]   = idx[i];
+                R->val[i]   = math::identity<value_type>();
+            }
+            return R;
+        }
+};
+
+// Backends working with builtin vectors move the data with index
+// gather/scatter, which avoids the matrix structure traffic of the spmv.
+template <class Backend>
+class schur_transfer<Backend,
+    typename std::enable_if<
+        backend::is_builtin_vector<typename Backend::vector>::value
+        >::type>
+{
+    public:
+        typedef typename Backend::params backend_params;
+
+        schur_transfer(size_t n, const std::vector<ptrdiff_t> &uidx,
+                const std::vector<ptrdiff_t> &pidx, const backend_params &bprm)
+            : x2u(n, uidx, bprm), x2p(n, pidx, bprm),
+              u2x(n, uidx, bprm), p2x(n, pidx, bprm),
+              nu(uidx.size()), np(pidx.size())
+        {}
+
+        template <class Vec1, class Vec2, class Vec3>
+        void gather(const Vec1 &x, Vec2 &u, Vec3 &p) const {
+            x2u(x, u);
+            x2p(x, p);
+        }
+
+        // The flow and pressure unknowns together cover the full vector, so
+        // there is no need to clear it first.
+        template <class Vec1, class Vec2, class Vec3>
+        void scatter(const Vec1 &u, const Vec2 &p, Vec3 &x) const {
+            u2x(u, x);
+            p2x(p, x);
+        }
+
+        size_t bytes() const {
+            return 2 * sizeof(ptrdiff_t) * (nu + np);
+        }
+    private:
+        typename Backend::gather  x2u, x2p;
+        typename Backend::scatter u2x, p2x;
+        size_t nu, np;
+};
+
+} // namespace detail
 
 /// Schur-complement pressure correction preconditioner
 template <class USolver, class PSolver>
@@ -205,8 +303,7 @@ class schur_pressure_correction {
 
         template <class Vec1, class Vec2>
         void apply(const Vec1 &rhs, Vec2 &&x) const {
-            backend::spmv(1, *x2u, rhs, 0, *rhs_u);
-            backend::spmv(1, *x2p, rhs, 0, *rhs_p);
+            transfer->gather(rhs, *rhs_u, *rhs_p);
 
             if (prm.type == 1) {
                 // Kuu u = rhs_u
@@ -237,9 +334,7 @@ class schur_pressure_correction {
                 report("U", (*U)(*rhs_u, *u));
             }
 
-            backend::clear(x);
-            backend::spmv(1, *u2x, *u, 1, x);
-            backend::spmv(1, *p2x, *p, 1, x);
+            transfer->scatter(*u, *p, x);
         }
 
         template <class Alpha, class Vec1, class Beta, class Vec2>
@@ -280,10 +375,7 @@ class schur_pressure_correction {
             b += backend::bytes(*K);
             b += backend::bytes(*Kup);
             b += backend::bytes(*Kpu);
-            b += backend::bytes(*x2u);
-            b += backend::bytes(*x2p);
-            b += backend::bytes(*u2x);
-            b += backend::bytes(*p2x);
+            b += transfer->bytes();
             b += backend::bytes(*rhs_u);
             b += backend::bytes(*rhs_p);
             b += backend::bytes(*u);
@@ -302,7 +394,8 @@ class schur_pressure_correction {
     private:
         size_t n, np, nu;
 
-        std::shared_ptr<matrix> K, Lm, Kup, Kpu, x2u, x2p, u2x, p2x;
+        std::shared_ptr<matrix> K, Lm, Kup, Kpu;
+        std::shared_ptr<detail::schur_transfer<backend_type>> transfer;
         std::shared_ptr<vector> rhs_u, rhs_p, u, p, tmp;
         std::shared_ptr<typename backend_type::matrix_diagonal> M;
         std::shared_ptr<typename backend_type::matrix_diagonal> Ld;
@@ -494,75 +587,15 @@ class schur_pressure_correction {
             if (prm.approx_schur)
                 M = backend_type::copy_vector(Kuu_dia, bprm);
 
-            // Scatter/Gather matrices
-            auto x2u = std::make_shared<build_matrix>();
-            auto x2p = std::make_shared<build_matrix>();
-            auto u2x = std::make_shared<build_matrix>();
-            auto p2x = std::make_shared<build_matrix>();
-
-            x2u->set_size(nu, n, true);
-            x2p->set_size(np, n, true);
-            u2x->set_size(n, nu, true);
-            p2x->set_size(n, np, true);
-
-            {
-                ptrdiff_t x2u_head = 0, x2u_idx = 0;
-                ptrdiff_t x2p_head = 0, x2p_idx = 0;
-                ptrdiff_t u2x_head = 0, u2x_idx = 0;
-                ptrdiff_t p2x_head = 0, p2x_idx = 0;
-
-                for(size_t i = 0; i < n; ++i) {
-                    if (prm.pmask[i]) {
-                        x2p->ptr[++x2p_idx] = ++x2p_head;
-                        ++p2x_head;
-                    } else {
-                        x2u->ptr[++x2u_idx] = ++x2u_head;
-                        ++u2x_head;
-                    }
-
-                    p2x->ptr[++p2x_idx] = p2x_head;
-                    u2x->ptr[++u2x_idx] = u2x_head;
-                }
-            }
-
-            x2u->set_nonzeros();
-            x2p->set_nonzeros();
-            u2x->set_nonzeros();
-            p2x->set_nonzeros();
+            // Scatter/Gather indices
+            std::vector<ptrdiff_t> uidx, pidx;
+            uidx.reserve(nu);
+            pidx.reserve(np);
 
-            {
-                ptrdiff_t x2u_head = 0;
-                ptrdiff_t x2p_head = 0;
-                ptrdiff_t u2x_head = 0;
-                ptrdiff_t p2x_head = 0;
-
-                for(size_t i = 0; i < n; ++i) {
-                    ptrdiff_t j = idx[i];
-
-                    if (prm.pmask[i]) {
-                        x2p->col[x2p_head] = i;
-                        x2p->val[x2p_head] = math::identity<value_type>();
-                        ++x2p_head;
-
-                        p2x->col[p2x_head] = j;
-                        p2x->val[p2x_head] = math::identity<value_type>();
-                        ++p2x_head;
-                    } else {
-                        x2u->col[x2u_head] = i;
-                        x2u->val[x2u_head] = math::identity<value_type>();
-                        ++x2u_head;
-
-                        u2x->col[u2x_head] = j;
-                        u2x->val[u2x_head] = math::identity<value_type>();
-                        ++u2x_head;
-                    }
-                }
-            }
+            for(size_t i = 0; i < n; ++i)
+                (prm.pmask[i] ? pidx : uidx).push_back(i);
 
-            this->x2u = backend_type::copy_matrix(x2u, bprm);
-            this->x2p = backend_type::copy_matrix(x2p, bprm);
-            this->u2x = backend_type::copy_matrix(u2x, bprm);
-            this->p2x = backend_type::copy_matrix(p2x, bprm);
+            transfer = std::make_shared<detail::schur_transfer<backend_type>>(n, uidx, pidx, bprm);
         }
 
         friend std::ostream& operator<<(std::ostream &os, const schur_pressure_correction &p) {
@@ -88,6 +88,13 @@ class chebyshev {
                   scale(false)
             {}
 
+            /// Copies the parameters of the relaxation with a different backend.
+            template <class P, class = decltype(P::degree)>
+            explicit params(const P &p)
+                : degree(p.degree), higher(p.higher), lower(p.lower),
+                  power_iters(p.power_iters), scale(p.scale)
+            {}
+
 #ifndef AMGCL_NO_BOOST
             params(const boost::property_tree::ptree &p)
                 : AMGCL_PARAMS_IMPORT_VALUE(p, degree),
@@ -54,6 +54,12 @@ struct ilu0< backend::cuda<real> > {
 
         params() : damping(1) {}
 
+        /// Copies the parameters of the relaxation with a different backend.
+        template <class P, class = decltype(P::damping)>
+        explicit params(const P &p)
+            : damping(p.damping)
+        {}
+
 #ifndef AMGCL_NO_BOOST
         params(const boost::property_tree::ptree &p)
             : AMGCL_PARAMS_IMPORT_VALUE(p, damping)
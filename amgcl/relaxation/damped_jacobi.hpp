@@ -62,6 +62,12 @@ struct damped_jacobi {
 
         params(scalar_type damping = 0.72) : damping(damping) {}
 
+        /// Copies the parameters of the relaxation with a different backend.
+        template <class P, class = decltype(P::damping)>
+        explicit params(const P &p)
+            : damping(p.damping)
+        {}
+
 #ifndef AMGCL_NO_BOOST
         params(const boost::property_tree::ptree &p)
             : AMGCL_PARAMS_IMPORT_VALUE(p, damping)
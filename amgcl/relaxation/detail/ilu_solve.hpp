@@ -59,6 +59,12 @@ class ilu_solve {
 
             params() : iters(2), damping(0.72) {}
 
+            /// Copies the parameters of the relaxation with a different backend.
+            template <class P, class = decltype(P::iters)>
+            explicit params(const P &p)
+                : iters(p.iters), damping(p.damping)
+            {}
+
 #ifndef AMGCL_NO_BOOST
             params(const boost::property_tree::ptree &p)
                 : AMGCL_PARAMS_IMPORT_VALUE(p, iters)
@@ -142,6 +148,12 @@ class ilu_solve< backend::builtin<value_type> > {
 
             params() : serial(num_threads() < 4) {}
 
+            /// Copies the parameters of the relaxation with a different backend.
+            template <class P, class = decltype(P::serial)>
+            explicit params(const P &p)
+                : serial(p.serial)
+            {}
+
 #ifndef AMGCL_NO_BOOST
             params(const boost::property_tree::ptree &p)
                 : AMGCL_PARAMS_IMPORT_VALUE(p, serial)
@@ -0,0 +1,232 @@
+#ifndef AMGCL_RELAXATION_DETAIL_PARILU_HPP
+#define AMGCL_RELAXATION_DETAIL_PARILU_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/relaxation/detail/parilu.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Fine-grained parallel incomplete LU factorization.
+ */
+
+#include <vector>
+#include <memory>
+
+#include <amgcl/backend/builtin.hpp>
+#include <amgcl/util.hpp>
+
+namespace amgcl {
+namespace relaxation {
+namespace detail {
+
+/// Fine-grained parallel ILU(0) factorization.
+/**
+ * Computes the incomplete LU factors with the sparsity pattern of A using
+ * the fixed-point iteration of Chow and Patel ("Fine-grained parallel
+ * incomplete LU factorization", SISC 37(2), 2015). Each sweep updates all
+ * nonzeros of the factors independently from the values of the previous
+ * sweep, so the result does not depend on the number of threads. A few
+ * sweeps are usually enough for the factors to be useful as a smoother.
+ *
+ * On output, L holds the strictly lower triangular part of the unit lower
+ * factor, U holds the strictly upper triangular part of the upper factor,
+ * and D holds the inverted diagonal of the upper factor. The columns in
+ * each row of A should be sorted, and the diagonal should be present.
+ */
+template <class Matrix, class value_type>
+void parilu0(const Matrix &A, unsigned sweeps,
+        std::shared_ptr< backend::crs<value_type> > &L,
+        std::shared_ptr< backend::crs<value_type> > &U,
+        std::shared_ptr< backend::numa_vector<value_type> > &D
+        )
+{
+    typedef backend::crs<value_type> build_matrix;
+
+    const ptrdiff_t n = backend::rows(A);
+
+    // The strictly lower part of A and the upper part of A with the
+    // diagonal (in the row-wise order).
+    L = std::make_shared<build_matrix>();
+    auto Uf = std::make_shared<build_matrix>();
+
+    L->set_size(n, n, true);
+    Uf->set_size(n, n, true);
+
+#pragma omp parallel for
+    for(ptrdiff_t i = 0; i < n; ++i) {
+        for(ptrdiff_t j = A.ptr[i], e = A.ptr[i + 1]; j < e; ++j) {
+            if (A.col[j] < i)
+                ++L->ptr[i + 1];
+            else
+                ++Uf->ptr[i + 1];
+        }
+    }
+
+    L->set_nonzeros(L->scan_row_sizes());
+    Uf->set_nonzeros(Uf->scan_row_sizes());
+
+    // Exceptions may not cross the parallel region boundaries, so the errors
+    // are counted and reported afterwards.
+    ptrdiff_t no_diag = 0;
+
+#pragma omp parallel for reduction(+:no_diag)
+    for(ptrdiff_t i = 0; i < n; ++i) {
+        ptrdiff_t lh = L->ptr[i], uh = Uf->ptr[i];
+        for(ptrdiff_t j = A.ptr[i], e = A.ptr[i + 1]; j < e; ++j) {
+            ptrdiff_t c = A.col[j];
+            if (c < i) {
+                L->col[lh] = c;
+                L->val[lh] = A.val[j];
+                ++lh;
+            } else {
+                Uf->col[uh] = c;
+                Uf->val[uh] = A.val[j];
+                ++uh;
+            }
+        }
+
+        if (uh == Uf->ptr[i] || Uf->col[Uf->ptr[i]] != i) ++no_diag;
+    }
+
+    precondition(!no_diag, "No diagonal value in system matrix");
+
+    // The upper factor is stored column-wise, so that the sums below may be
+    // computed by merging a row of L with a column of U. The diagonal is the
+    // last element in each column.
+    auto Ut = backend::transpose(*Uf);
+
+    const ptrdiff_t Lnz = backend::nonzeros(*L);
+    const ptrdiff_t Unz = backend::nonzeros(*Ut);
+
+    std::vector<value_type> Lval(L->val, L->val + Lnz);
+    std::vector<value_type> Uval(Ut->val, Ut->val + Unz);
+
+    // The initial approximation.
+    ptrdiff_t zero_pivot = 0;
+
+#pragma omp parallel for reduction(+:zero_pivot)
+    for(ptrdiff_t i = 0; i < n; ++i) {
+        if (math::is_zero(Ut->val[Ut->ptr[i + 1] - 1])) ++zero_pivot;
+    }
+
+    precondition(!zero_pivot, "Zero pivot in ILU");
+
+#pragma omp parallel for
+    for(ptrdiff_t i = 0; i < n; ++i) {
+        for(ptrdiff_t j = L->ptr[i], e = L->ptr[i + 1]; j < e; ++j) {
+            const value_type &d = Ut->val[Ut->ptr[L->col[j] + 1] - 1];
+            Lval[j] = Lval[j] * math::inverse(d);
+        }
+    }
+
+    std::vector<value_type> Lnew(Lnz), Unew(Unz);
+
+    // Sum of l_ik * u_kj over k < kmax.
+    auto dot = [&](ptrdiff_t i, ptrdiff_t j, ptrdiff_t kmax) {
+        value_type s = math::zero<value_type>();
+
+        ptrdiff_t a = L->ptr[i],  ae = L->ptr[i + 1];
+        ptrdiff_t b = Ut->ptr[j], be = Ut->ptr[j + 1];
+
+        while(a < ae && b < be) {
+            ptrdiff_t ca = L->col[a];
+            ptrdiff_t cb = Ut->col[b];
+
+            if (ca >= kmax || cb >= kmax) break;
+
+            if (ca < cb) {
+                ++a;
+            } else if (cb < ca) {
+                ++b;
+            } else {
+                s += Lval[a++] * Uval[b++];
+            }
+        }
+
+        return s;
+    };
+
+    for(unsigned sweep = 0; sweep < sweeps; ++sweep) {
+#pragma omp parallel for
+        for(ptrdiff_t i = 0; i < n; ++i) {
+            for(ptrdiff_t j = L->ptr[i], e = L->ptr[i + 1]; j < e; ++j) {
+                ptrdiff_t c = L->col[j];
+                const value_type &d = Uval[Ut->ptr[c + 1] - 1];
+
+                Lnew[j] = (L->val[j] - dot(i, c, c)) * math::inverse(d);
+            }
+        }
+
+        zero_pivot = 0;
+
+#pragma omp parallel for reduction(+:zero_pivot)
+        for(ptrdiff_t j = 0; j < n; ++j) {
+            for(ptrdiff_t k = Ut->ptr[j], e = Ut->ptr[j + 1]; k < e; ++k) {
+                ptrdiff_t r = Ut->col[k];
+                Unew[k] = Ut->val[k] - dot(r, j, r);
+            }
+
+            if (math::is_zero(Unew[Ut->ptr[j + 1] - 1])) ++zero_pivot;
+        }
+
+        precondition(!zero_pivot, "Zero pivot in ILU");
+
+        Lval.swap(Lnew);
+        Uval.swap(Unew);
+    }
+
+    // Move the values to the factors.
+    std::copy(Lval.begin(), Lval.end(), L->val);
+    std::copy(Uval.begin(), Uval.end(), Ut->val);
+
+    Uf = backend::transpose(*Ut);
+
+    U = std::make_shared<build_matrix>();
+    U->set_size(n, n, true);
+    D = std::make_shared< backend::numa_vector<value_type> >(n, false);
+
+#pragma omp parallel for
+    for(ptrdiff_t i = 0; i < n; ++i) {
+        (*D)[i] = math::inverse(Uf->val[Uf->ptr[i]]);
+        U->ptr[i + 1] = Uf->ptr[i + 1] - Uf->ptr[i] - 1;
+    }
+
+    U->set_nonzeros(U->scan_row_sizes());
+
+#pragma omp parallel for
+    for(ptrdiff_t i = 0; i < n; ++i) {
+        ptrdiff_t h = U->ptr[i];
+        for(ptrdiff_t j = Uf->ptr[i] + 1, e = Uf->ptr[i + 1]; j < e; ++j, ++h) {
+            U->col[h] = Uf->col[j];
+            U->val[h] = Uf->val[j];
+        }
+    }
+}
+
+} // namespace detail
+} // namespace relaxation
+} // namespace amgcl
+
+#endif
@@ -63,6 +63,12 @@ struct gauss_seidel {
 
         params() : serial(false) {}
 
+        /// Copies the parameters of the relaxation with a different backend.
+        template <class P, class = decltype(P::serial)>
+        explicit params(const P &p)
+            : serial(p.serial)
+        {}
+
 #ifndef AMGCL_NO_BOOST
         params(const boost::property_tree::ptree &p)
             : AMGCL_PARAMS_IMPORT_VALUE(p, serial)
@@ -155,7 +161,7 @@ struct gauss_seidel {
                 const Matrix &A, const VectorRHS &rhs, VectorX &x, bool forward)
         {
             typedef typename backend::value_type<Matrix>::type val_type;
-            typedef typename math::rhs_of<val_type>::type rhs_type;
+            typedef typename backend::value_type<VectorX>::type rhs_type;
 
             const ptrdiff_t n = backend::rows(A);
 
@@ -185,7 +191,6 @@ struct gauss_seidel {
         template <bool forward>
         struct parallel_sweep {
             typedef typename Backend::value_type value_type;
-            typedef typename math::rhs_of<value_type>::type rhs_type;
 
             struct task {
                 ptrdiff_t beg, end;
@@ -320,6 +325,8 @@ struct gauss_seidel {
 
             template <class Vector1, class Vector2>
             void sweep(const Vector1 &rhs, Vector2 &x) const {
+                typedef typename backend::value_type<Vector2>::type rhs_type;
+
 #pragma omp parallel
                 {
                     int tid = thread_id();
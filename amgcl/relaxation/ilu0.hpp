@@ -34,15 +34,18 @@ THE SOFTWARE.
 #include <amgcl/backend/builtin.hpp>
 #include <amgcl/util.hpp>
 #include <amgcl/relaxation/detail/ilu_solve.hpp>
+#include <amgcl/relaxation/detail/parilu.hpp>
 
 namespace amgcl {
 namespace relaxation {
 
 /// ILU(0) smoother.
 /**
- * \note ILU(0) is a serial algorithm and is only applicable to backends that
- * support matrix row iteration (e.g. amgcl::backend::builtin or
- * amgcl::backend::eigen).
+ * \note The factorization is computed with a serial algorithm, unless
+ * params::factor_sweeps is set, in which case the fine-grained parallel
+ * factorization (see relaxation::detail::parilu0) is used. The smoother is
+ * only applicable to backends that support matrix row iteration (e.g.
+ * amgcl::backend::builtin or amgcl::backend::eigen).
  *
  * \param Backend Backend for temporary structures allocation.
  * \ingroup relaxation
@@ -62,21 +65,38 @@ struct ilu0 {
         /// Damping factor.
         scalar_type damping;
 
+        /// Number of sweeps of the parallel factorization.
+        /**
+         * When zero, the exact factorization is computed sequentially.
+         * Otherwise, the factors are approximated with the given number of
+         * fine-grained parallel fixed-point sweeps. Usually 2-3 sweeps are
+         * enough for the smoother to work as well as the exact one.
+         */
+        unsigned factor_sweeps;
+
         /// Parameters for sparse triangular system solver
         typename ilu_solve::params solve;
 
-        params() : damping(1) {}
+        params() : damping(1), factor_sweeps(0) {}
+
+        /// Copies the parameters of the relaxation with a different backend.
+        template <class P, class = decltype(P::factor_sweeps)>
+        explicit params(const P &p)
+            : damping(p.damping), factor_sweeps(p.factor_sweeps), solve(p.solve)
+        {}
 
 #ifndef AMGCL_NO_BOOST
         params(const boost::property_tree::ptree &p)
             : AMGCL_PARAMS_IMPORT_VALUE(p, damping)
+            , AMGCL_PARAMS_IMPORT_VALUE(p, factor_sweeps)
             , AMGCL_PARAMS_IMPORT_CHILD(p, solve)
         {
-            check_params(p, {"damping", "solve"});
+            check_params(p, {"damping", "factor_sweeps", "solve"});
         }
 
         void get(boost::property_tree::ptree &p, const std::string &path) const {
             AMGCL_PARAMS_EXPORT_VALUE(p, path, damping);
+            AMGCL_PARAMS_EXPORT_VALUE(p, path, factor_sweeps);
             AMGCL_PARAMS_EXPORT_CHILD(p, path, solve);
         }
 #endif
@@ -90,6 +110,16 @@ struct ilu0 {
         typedef typename backend::builtin<value_type>::matrix build_matrix;
         const size_t n = backend::rows(A);
 
+        if (prm.factor_sweeps) {
+            std::shared_ptr<build_matrix> L, U;
+            std::shared_ptr<backend::numa_vector<value_type> > D;
+
+            detail::parilu0(A, prm.factor_sweeps, L, U, D);
+
+            ilu = std::make_shared<ilu_solve>(L, U, D, prm.solve, bprm);
+            return;
+        }
+
         size_t Lnz = 0, Unz = 0;
 
         for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(n); ++i) {
@@ -69,6 +69,12 @@ struct iluk {
 
         params() : k(1), damping(1) {}
 
+        /// Copies the parameters of the relaxation with a different backend.
+        template <class P, class = decltype(P::k)>
+        explicit params(const P &p)
+            : k(p.k), damping(p.damping), solve(p.solve)
+        {}
+
 #ifndef AMGCL_NO_BOOST
         params(const boost::property_tree::ptree &p)
             : AMGCL_PARAMS_IMPORT_VALUE(p, k)
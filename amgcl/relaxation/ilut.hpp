@@ -79,6 +79,12 @@ struct ilut {
 
         params() : p(2), tau(1e-2f), damping(1) {}
 
+        /// Copies the parameters of the relaxation with a different backend.
+        template <class P, class = decltype(P::tau)>
+        explicit params(const P &src)
+            : p(src.p), tau(src.tau), damping(src.damping), solve(src.solve)
+        {}
+
 #ifndef AMGCL_NO_BOOST
         params(const boost::property_tree::ptree &p)
             : AMGCL_PARAMS_IMPORT_VALUE(p, p)
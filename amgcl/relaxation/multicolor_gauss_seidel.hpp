@@ -0,0 +1,309 @@
+#ifndef AMGCL_RELAXATION_MULTICOLOR_GAUSS_SEIDEL_HPP
+#define AMGCL_RELAXATION_MULTICOLOR_GAUSS_SEIDEL_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/relaxation/multicolor_gauss_seidel.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Multicolor Gauss-Seidel relaxation scheme.
+ */
+
+#include <vector>
+#include <numeric>
+#include <memory>
+
+#include <amgcl/backend/builtin.hpp>
+#include <amgcl/backend/interface.hpp>
+#include <amgcl/util.hpp>
+
+namespace amgcl {
+namespace relaxation {
+
+/// Multicolor Gauss-Seidel relaxation.
+/**
+ * The graph of the matrix is colored at setup, so that the rows of the same
+ * color do not depend on each other. The rows are then reordered by color,
+ * and a sweep consists of one fully parallel pass per color. Unlike the level
+ * scheduling in gauss_seidel, the number of synchronization points per sweep
+ * is the number of colors, which is small and does not depend on the problem
+ * size. The smoothing properties are close to those of the lexicographic
+ * Gauss-Seidel.
+ *
+ * \note This relaxation is only applicable to backends that support matrix
+ * row iteration (e.g. amgcl::backend::builtin or amgcl::backend::eigen).
+ *
+ * \param Backend Backend for temporary structures allocation.
+ * \ingroup relaxation
+ */
+template <class Backend>
+struct multicolor_gauss_seidel {
+    typedef typename Backend::value_type value_type;
+
+    /// Relaxation parameters.
+    struct params {
+        /// Do both forward and backward sweeps on each application.
+        /**
+         * By default, pre-relaxation is a forward sweep, and post-relaxation
+         * is a backward sweep.
+         */
+        bool symmetric;
+
+        params() : symmetric(false) {}
+
+        /// Copies the parameters of the relaxation with a different backend.
+        template <class P, class = decltype(P::symmetric)>
+        explicit params(const P &p)
+            : symmetric(p.symmetric)
+        {}
+
+#ifndef AMGCL_NO_BOOST
+        params(const boost::property_tree::ptree &p)
+            : AMGCL_PARAMS_IMPORT_VALUE(p, symmetric)
+        {
+            check_params(p, {"symmetric"});
+        }
+
+        void get(boost::property_tree::ptree &p, const std::string &path) const {
+            AMGCL_PARAMS_EXPORT_VALUE(p, path, symmetric);
+        }
+#endif
+    } prm;
+
+    /// \copydoc amgcl::relaxation::damped_jacobi::damped_jacobi
+    template <class Matrix>
+    multicolor_gauss_seidel(const Matrix &A, const params &prm, const typename Backend::params&)
+        : prm(prm)
+    {
+        const ptrdiff_t n = backend::rows(A);
+
+        std::vector<int> color;
+        int ncolors = color_graph(A, color);
+
+        // Order rows by color.
+        start.resize(ncolors + 1, 0);
+        for(ptrdiff_t i = 0; i < n; ++i) ++start[color[i] + 1];
+        std::partial_sum(start.begin(), start.end(), start.begin());
+
+        ord.resize(n, false);
+        {
+            std::vector<ptrdiff_t> pos(start.begin(), start.end() - 1);
+            for(ptrdiff_t i = 0; i < n; ++i) ord[pos[color[i]]++] = i;
+        }
+
+        // Reorganize matrix data by color, with the inverted diagonal stored
+        // separately. The arrays are filled with the same schedule as used by
+        // the sweeps, so that the memory pages are touched by the threads
+        // that will work with them.
+        ptr.resize(n + 1, false);
+        dia.resize(n, false);
+        ptr[0] = 0;
+
+#pragma omp parallel
+        for(int c = 0; c < ncolors; ++c) {
+#pragma omp for
+            for(ptrdiff_t r = start[c]; r < start[c+1]; ++r) {
+                ptrdiff_t i = ord[r], nnz = 0;
+                for(auto a = backend::row_begin(A, i); a; ++a)
+                    if (a.col() != i) ++nnz;
+                ptr[r+1] = nnz;
+            }
+        }
+
+        for(ptrdiff_t r = 0; r < n; ++r) ptr[r+1] += ptr[r];
+
+        col.resize(ptr[n], false);
+        val.resize(ptr[n], false);
+
+#pragma omp parallel
+        for(int c = 0; c < ncolors; ++c) {
+#pragma omp for
+            for(ptrdiff_t r = start[c]; r < start[c+1]; ++r) {
+                ptrdiff_t i = ord[r], j = ptr[r];
+                value_type D = math::identity<value_type>();
+
+                for(auto a = backend::row_begin(A, i); a; ++a) {
+                    if (a.col() == i) {
+                        D = a.value();
+                    } else {
+                        col[j] = a.col();
+                        val[j] = a.value();
+                        ++j;
+                    }
+                }
+
+                dia[r] = math::inverse(D);
+            }
+        }
+    }
+
+    /// \copydoc amgcl::relaxation::damped_jacobi::apply_pre
+    template <class Matrix, class VectorRHS, class VectorX, class VectorTMP>
+    void apply_pre(
+            const Matrix&, const VectorRHS &rhs, VectorX &x, VectorTMP&
+            ) const
+    {
+        sweep(rhs, x, true);
+        if (prm.symmetric) sweep(rhs, x, false);
+    }
+
+    /// \copydoc amgcl::relaxation::damped_jacobi::apply_post
+    template <class Matrix, class VectorRHS, class VectorX, class VectorTMP>
+    void apply_post(
+            const Matrix&, const VectorRHS &rhs, VectorX &x, VectorTMP&
+            ) const
+    {
+        if (prm.symmetric) sweep(rhs, x, true);
+        sweep(rhs, x, false);
+    }
+
+    template <class Matrix, class VectorRHS, class VectorX>
+    void apply(const Matrix&, const VectorRHS &rhs, VectorX &x) const
+    {
+        backend::clear(x);
+        sweep(rhs, x, true);
+        sweep(rhs, x, false);
+    }
+
+    /// Number of colors in the matrix graph.
+    int colors() const {
+        return static_cast<int>(start.size()) - 1;
+    }
+
+    size_t bytes() const {
+        return
+            backend::bytes(start) +
+            backend::bytes(ord) +
+            backend::bytes(ptr) +
+            backend::bytes(col) +
+            backend::bytes(val) +
+            backend::bytes(dia);
+    }
+
+    private:
+        std::vector<ptrdiff_t> start;
+
+        backend::numa_vector<ptrdiff_t>  ord;
+        backend::numa_vector<ptrdiff_t>  ptr;
+        backend::numa_vector<ptrdiff_t>  col;
+        backend::numa_vector<value_type> val;
+        backend::numa_vector<value_type> dia;
+
+        // Greedy distance-1 coloring of the (symmetrized) matrix graph.
+        // Returns the number of colors.
+        template <class Matrix>
+        static int color_graph(const Matrix &A, std::vector<int> &color) {
+            const ptrdiff_t n = backend::rows(A);
+
+            // Rows of the same color should not reference each other in
+            // either direction, so the transposed pattern is needed as well.
+            std::vector<ptrdiff_t> tptr(n + 1, 0);
+            for(ptrdiff_t i = 0; i < n; ++i)
+                for(auto a = backend::row_begin(A, i); a; ++a)
+                    ++tptr[a.col() + 1];
+
+            std::partial_sum(tptr.begin(), tptr.end(), tptr.begin());
+
+            std::vector<ptrdiff_t> tcol(tptr[n]);
+            for(ptrdiff_t i = 0; i < n; ++i)
+                for(auto a = backend::row_begin(A, i); a; ++a)
+                    tcol[tptr[a.col()]++] = i;
+
+            std::rotate(tptr.begin(), tptr.end() - 1, tptr.end());
+            tptr[0] = 0;
+
+            color.assign(n, -1);
+            std::vector<ptrdiff_t> forbidden;
+            int ncolors = 0;
+
+            for(ptrdiff_t i = 0; i < n; ++i) {
+                for(auto a = backend::row_begin(A, i); a; ++a) {
+                    int c = color[a.col()];
+                    if (c >= 0) forbidden[c] = i;
+                }
+
+                for(ptrdiff_t j = tptr[i]; j < tptr[i+1]; ++j) {
+                    int c = color[tcol[j]];
+                    if (c >= 0) forbidden[c] = i;
+                }
+
+                int c = 0;
+                while(c < ncolors && forbidden[c] == i) ++c;
+
+                if (c == ncolors) {
+                    ++ncolors;
+                    forbidden.push_back(-1);
+                }
+
+                color[i] = c;
+            }
+
+            return ncolors;
+        }
+
+        template <class VectorRHS, class VectorX>
+        void sweep(const VectorRHS &rhs, VectorX &x, bool forward) const {
+            typedef typename backend::value_type<VectorX>::type rhs_type;
+
+            const int nc = colors();
+
+#pragma omp parallel
+            for(int k = 0; k < nc; ++k) {
+                const int c = forward ? k : nc - 1 - k;
+
+#pragma omp for
+                for(ptrdiff_t r = start[c]; r < start[c+1]; ++r) {
+                    ptrdiff_t i = ord[r];
+
+                    rhs_type X;
+                    X = rhs[i];
+
+                    for(ptrdiff_t j = ptr[r], e = ptr[r+1]; j < e; ++j)
+                        X -= val[j] * x[col[j]];
+
+                    x[i] = dia[r] * X;
+                }
+            }
+        }
+};
+
+} // namespace relaxation
+
+namespace backend {
+
+template <class Backend>
+struct relaxation_is_supported<
+    Backend,
+    relaxation::multicolor_gauss_seidel,
+    typename std::enable_if<
+        !Backend::provides_row_iterator::value
+        >::type
+    > : std::false_type
+{};
+
+} // namespace backend
+} // namespace amgcl
+
+#endif
@@ -41,6 +41,7 @@ THE SOFTWARE.
 
 #include <amgcl/util.hpp>
 #include <amgcl/relaxation/gauss_seidel.hpp>
+#include <amgcl/relaxation/multicolor_gauss_seidel.hpp>
 #include <amgcl/relaxation/ilu0.hpp>
 #include <amgcl/relaxation/iluk.hpp>
 #include <amgcl/relaxation/ilut.hpp>
@@ -62,7 +63,8 @@ enum type {
     damped_jacobi,              ///< Damped Jacobi
     spai0,                      ///< Sparse approximate inverse of 0th order
     spai1,                      ///< Sparse approximate inverse of 1st order
-    chebyshev                   ///< Chebyshev relaxation
+    chebyshev,                  ///< Chebyshev relaxation
+    multicolor_gauss_seidel     ///< Multicolor Gauss-Seidel smoothing
 };
 
 inline std::ostream& operator<<(std::ostream &os, type r)
@@ -84,6 +86,8 @@ inline std::ostream& operator<<(std::ostream &os, type r)
             return os << "spai1";
         case chebyshev:
             return os << "chebyshev";
+        case multicolor_gauss_seidel:
+            return os << "multicolor_gauss_seidel";
         default:
             return os << "???";
     }
@@ -110,9 +114,11 @@ inline std::istream& operator>>(std::istream &in, type &r)
         r = spai1;
     else if (val == "chebyshev")
         r = chebyshev;
+    else if (val == "multicolor_gauss_seidel")
+        r = multicolor_gauss_seidel;
     else
         throw std::invalid_argument("Invalid relaxation value. Valid choices are:"
-                "gauss_seidel, ilu0, iluk, ilut, damped_jacobi, spai0, spai1, chebyshev.");
+                "gauss_seidel, ilu0, iluk, ilut, damped_jacobi, spai0, spai1, chebyshev, multicolor_gauss_seidel.");
 
     return in;
 }
@@ -147,6 +153,7 @@ struct wrapper {
             AMGCL_RUNTIME_RELAXATION(spai0);
             AMGCL_RUNTIME_RELAXATION(spai1);
             AMGCL_RUNTIME_RELAXATION(chebyshev);
+            AMGCL_RUNTIME_RELAXATION(multicolor_gauss_seidel);
 
 #undef AMGCL_RUNTIME_RELAXATION
 
@@ -171,6 +178,7 @@ struct wrapper {
             AMGCL_RUNTIME_RELAXATION(spai0);
             AMGCL_RUNTIME_RELAXATION(spai1);
             AMGCL_RUNTIME_RELAXATION(chebyshev);
+            AMGCL_RUNTIME_RELAXATION(multicolor_gauss_seidel);
 
 #undef AMGCL_RUNTIME_RELAXATION
         }
@@ -196,6 +204,7 @@ struct wrapper {
             AMGCL_RUNTIME_RELAXATION(spai0);
             AMGCL_RUNTIME_RELAXATION(spai1);
             AMGCL_RUNTIME_RELAXATION(chebyshev);
+            AMGCL_RUNTIME_RELAXATION(multicolor_gauss_seidel);
 
 #undef AMGCL_RUNTIME_RELAXATION
 
@@ -224,6 +233,7 @@ struct wrapper {
             AMGCL_RUNTIME_RELAXATION(spai0);
             AMGCL_RUNTIME_RELAXATION(spai1);
             AMGCL_RUNTIME_RELAXATION(chebyshev);
+            AMGCL_RUNTIME_RELAXATION(multicolor_gauss_seidel);
 
 #undef AMGCL_RUNTIME_RELAXATION
 
@@ -250,6 +260,7 @@ struct wrapper {
             AMGCL_RUNTIME_RELAXATION(spai0);
             AMGCL_RUNTIME_RELAXATION(spai1);
             AMGCL_RUNTIME_RELAXATION(chebyshev);
+            AMGCL_RUNTIME_RELAXATION(multicolor_gauss_seidel);
 
 #undef AMGCL_RUNTIME_RELAXATION
 
@@ -273,6 +284,7 @@ struct wrapper {
             AMGCL_RUNTIME_RELAXATION(spai0);
             AMGCL_RUNTIME_RELAXATION(spai1);
             AMGCL_RUNTIME_RELAXATION(chebyshev);
+            AMGCL_RUNTIME_RELAXATION(multicolor_gauss_seidel);
 
 #undef AMGCL_RUNTIME_RELAXATION
 
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include <tuple>
 #include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/workspace.hpp>
 #include <amgcl/solver/detail/default_inner_product.hpp>
 #include <amgcl/solver/precond_side.hpp>
 #include <amgcl/util.hpp>
@@ -62,7 +63,7 @@ class bicgstab {
         typedef typename math::scalar_of<value_type>::type scalar_type;
 
         typedef typename math::inner_product_impl<
-            typename math::rhs_of<value_type>::type
+            typename backend::vector_value_type<Backend>::type
             >::return_type coef_type;
 
 
@@ -118,13 +119,7 @@ class bicgstab {
                 const InnerProduct &inner_product = InnerProduct()
                 )
             : prm(prm), n(n),
-              r ( Backend::create_vector(n, backend_prm) ),
-              p ( Backend::create_vector(n, backend_prm) ),
-              v ( Backend::create_vector(n, backend_prm) ),
-              s ( Backend::create_vector(n, backend_prm) ),
-              t ( Backend::create_vector(n, backend_prm) ),
-              rh( Backend::create_vector(n, backend_prm) ),
-              T ( Backend::create_vector(n, backend_prm) ),
+              work(7, n, backend_prm),
               inner_product(inner_product)
         { }
 
@@ -149,12 +144,18 @@ class bicgstab {
             static const coef_type one  = math::identity<coef_type>();
             static const coef_type zero = math::zero<coef_type>();
 
-            scalar_type norm_rhs = norm(rhs);
+            const coef_type rhs2 = inner_product(rhs, rhs);
+            scalar_type norm_rhs = sqrt(math::norm(rhs2));
             if (norm_rhs < amgcl::detail::eps<scalar_type>(1)) {
                 backend::clear(x);
                 return std::make_tuple(0, norm_rhs);
             }
 
+            auto w = work.get();
+            const std::shared_ptr<vector>
+                &r = w[0], &p = w[1], &v = w[2], &s = w[3],
+                &t = w[4], &rh = w[5], &T = w[6];
+
             if (prm.pside == side::left) {
                 backend::residual(rhs, A, x, *rh);
                 P.apply(*rh, *r);
@@ -163,8 +164,8 @@ class bicgstab {
             }
             backend::copy(*r, *rh);
 
-            scalar_type eps = std::max(norm_rhs * prm.tol, prm.abstol);
-            scalar_type res = prm.check_after ? 2 * eps : norm(*r);
+            scalar_type res = 2 * prm.tol;
+            bool done = !prm.check_after && converged(inner_product(*r, *r), rhs2, res);
 
             coef_type rho1  = zero;
             coef_type rho2  = zero;
@@ -172,7 +173,7 @@ class bicgstab {
             coef_type omega = zero;
 
             size_t iter = 0;
-            for(bool first = true; res > eps && iter < prm.maxiter; ++iter) {
+            for(bool first = true; !done && iter < prm.maxiter; ++iter) {
 
                 rho2 = rho1;
                 rho1 = inner_product(*r, *rh);
@@ -198,7 +199,7 @@ class bicgstab {
 
                 backend::axpbypcz(one, *r, -alpha, *v, zero, *s);
 
-                if ((res = norm(*s)) > eps) {
+                if (!(done = converged(inner_product(*s, *s), rhs2, res))) {
                     preconditioner::spmv(prm.pside, P, A, *s, *t, *T);
 
                     omega = inner_product(*t, *s) / inner_product(*t, *t);
@@ -213,11 +214,11 @@ class bicgstab {
 
                     backend::axpbypcz(one, *s, -omega, *t, zero, *r);
 
-                    res = norm(*r);
+                    done = converged(inner_product(*r, *r), rhs2, res);
                 }
             }
 
-            return std::make_tuple(iter, res / norm_rhs);
+            return std::make_tuple(iter, res);
         }
 
         /* Computes the solution for the given right-hand side \p rhs. The
@@ -235,14 +236,7 @@ class bicgstab {
         }
 
         size_t bytes() const {
-            return
-                backend::bytes(*r) +
-                backend::bytes(*p) +
-                backend::bytes(*v) +
-                backend::bytes(*s) +
-                backend::bytes(*t) +
-                backend::bytes(*rh) +
-                backend::bytes(*T);
+            return backend::bytes(work);
         }
 
         friend std::ostream& operator<<(std::ostream &os, const bicgstab &s) {
@@ -258,19 +252,17 @@ class bicgstab {
     private:
         size_t n;
 
-        std::shared_ptr<vector> r;
-        std::shared_ptr<vector> p;
-        std::shared_ptr<vector> v;
-        std::shared_ptr<vector> s;
-        std::shared_ptr<vector> t;
-        std::shared_ptr<vector> rh;
-        std::shared_ptr<vector> T;
+        backend::work_vectors<Backend> work;
 
         InnerProduct inner_product;
 
-        template <class Vec>
-        scalar_type norm(const Vec &x) const {
-            return sqrt(math::norm(inner_product(x, x)));
+        // Checks the residual against the tolerances given the inner products
+        // r2 = (r,r) and f2 = (rhs,rhs), and returns the relative residual.
+        // The relative residual of a multi_rhs vector is the largest one of
+        // its systems.
+        bool converged(const coef_type &r2, const coef_type &f2, scalar_type &res) const {
+            res = math::relative_norm(r2, f2);
+            return res <= prm.tol || sqrt(math::norm(r2)) <= prm.abstol;
         }
 };
 
@@ -0,0 +1,495 @@
+#ifndef AMGCL_SOLVER_CA_GMRES_HPP
+#define AMGCL_SOLVER_CA_GMRES_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   ca_gmres.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Communication-avoiding (s-step) GMRES method.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/workspace.hpp>
+#include <amgcl/solver/detail/default_inner_product.hpp>
+#include <amgcl/solver/detail/givens_rotations.hpp>
+#include <amgcl/solver/precond_side.hpp>
+#include <amgcl/util.hpp>
+
+namespace amgcl {
+namespace solver {
+
+/** Communication-avoiding (s-step) GMRES method.
+ * \rst
+ * The Krylov basis is extended by blocks of :math:`s` vectors at once. The
+ * vectors of a block are generated with :math:`s` consecutive applications
+ * of the (preconditioned) operator, and are then orthogonalized against the
+ * previous basis with two passes of the block classical Gram-Schmidt and
+ * against each other with the Cholesky QR. The Gram matrix of the block is
+ * collected along with the second Gram-Schmidt pass, so that each block takes
+ * two global reductions, instead of one reduction per inner product in
+ * the modified Gram-Schmidt of the GMRES. The Hessenberg matrix is recovered
+ * from the triangular factors, and the rest is as in GMRES.
+ *
+ * The monomial basis is used, so larger values of :math:`s` lead to
+ * ill-conditioned blocks. When the Cholesky factorization breaks down, the
+ * block is truncated and the method restarts.
+ * \endrst
+ */
+template <
+    class Backend,
+    class InnerProduct = detail::default_inner_product
+    >
+class ca_gmres {
+    public:
+        typedef Backend backend_type;
+
+        typedef typename Backend::vector     vector;
+        typedef typename Backend::value_type value_type;
+        typedef typename Backend::params     backend_params;
+
+        typedef typename backend::work_vectors<Backend>::vector_set vector_set;
+
+        typedef typename math::scalar_of<value_type>::type scalar_type;
+        typedef typename math::rhs_of<value_type>::type rhs_type;
+        typedef typename math::inner_product_impl<rhs_type>::return_type coef_type;
+
+        /// Solver parameters.
+        struct params {
+            /// Number of iterations before restart.
+            unsigned M;
+
+            /// Number of basis vectors generated at once.
+            unsigned s;
+
+            /// Preconditioning kind (left/right).
+            preconditioner::side::type pside;
+
+            /// Maximum number of iterations.
+            unsigned maxiter;
+
+            /// Target relative residual error.
+            scalar_type tol;
+
+            /// Target absolute residual error.
+            scalar_type abstol;
+
+            params()
+                : M(30), s(5), pside(preconditioner::side::right),
+                  maxiter(100), tol(1e-8),
+                  abstol(std::numeric_limits<scalar_type>::min())
+            { }
+
+#ifndef AMGCL_NO_BOOST
+            params(const boost::property_tree::ptree &p)
+                : AMGCL_PARAMS_IMPORT_VALUE(p, M),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, s),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, pside),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, maxiter),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, tol),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, abstol)
+            {
+                check_params(p, {"M", "s", "pside", "maxiter", "tol", "abstol"});
+            }
+
+            void get(boost::property_tree::ptree &p, const std::string &path) const {
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, M);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, s);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, pside);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, maxiter);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, tol);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, abstol);
+            }
+#endif
+        };
+
+        /// Preallocates necessary data structures for the system of size \p n.
+        ca_gmres(
+                size_t n,
+                const params &prm = params(),
+                const backend_params &backend_prm = backend_params(),
+                const InnerProduct &inner_product = InnerProduct()
+             )
+            : prm(prm), n(n),
+              H(prm.M + 1, prm.M), Hr(prm.M + 1, prm.M),
+              C(prm.M + 1, prm.s), R(prm.s, prm.s), G(prm.s, prm.s),
+              s(prm.M + 1), cs(prm.M + 1), sn(prm.M + 1),
+              work(2, n, backend_prm), basis(prm.M + 1, n, backend_prm),
+              inner_product(inner_product)
+        {
+            precondition(prm.s > 0 && prm.s <= prm.M,
+                    "CA-GMRES: s should be between 1 and M");
+        }
+
+        /* Computes the solution for the given system matrix \p A and the
+         * right-hand side \p rhs.  Returns the number of iterations made and
+         * the achieved residual as a ``std::tuple``. The solution vector
+         * \p x provides initial approximation in input and holds the computed
+         * solution on output.
+         *
+         * The system matrix may differ from the matrix used during
+         * initialization. This may be used for the solution of non-stationary
+         * problems with slowly changing coefficients. There is a strong chance
+         * that a preconditioner built for a time step will act as a reasonably
+         * good preconditioner for several subsequent time steps [DeSh12]_.
+         */
+        template <class Matrix, class Precond, class Vec1, class Vec2>
+        std::tuple<size_t, scalar_type> operator()(
+                Matrix  const &A,
+                Precond const &P,
+                Vec1    const &rhs,
+                Vec2          &x
+                ) const
+        {
+            namespace side = preconditioner::side;
+
+            static const scalar_type zero = math::zero<scalar_type>();
+            static const scalar_type one  = math::identity<scalar_type>();
+
+            scalar_type norm_rhs = norm(rhs);
+            if (norm_rhs < amgcl::detail::eps<scalar_type>(1)) {
+                backend::clear(x);
+                return std::make_tuple(0, norm_rhs);
+            }
+
+            scalar_type eps = std::max(prm.tol * norm_rhs, prm.abstol);
+            scalar_type norm_r = zero;
+
+            // Scaling of the monomial basis (estimate of the operator norm).
+            scalar_type sigma = one;
+
+            auto w = work.get();
+            const std::shared_ptr<vector> &r = w[0], &t = w[1];
+            const vector_set v = basis.get();
+
+            size_t iter = 0;
+            while(true) {
+                if (prm.pside == side::left) {
+                    backend::residual(rhs, A, x, *v[0]);
+                    P.apply(*v[0], *r);
+                } else {
+                    backend::residual(rhs, A, x, *r);
+                }
+
+                // -- Check stopping condition
+                norm_r = norm(*r);
+                if (norm_r < eps || iter >= prm.maxiter) break;
+
+                backend::axpby(math::inverse(norm_r), *r, zero, *v[0]);
+
+                std::fill(s.begin(), s.end(), 0);
+                s[0] = norm_r;
+
+                unsigned j = 0;
+                bool done = false;
+                while(!done) {
+                    unsigned m = std::min(prm.s, prm.M - j);
+
+                    // -- Matrix powers: v[j+i] = (op / sigma)^i v[j]
+                    for(unsigned i = 1; i <= m; ++i) {
+                        preconditioner::spmv(prm.pside, P, A, *v[j+i-1], *v[j+i], *r);
+                        if (sigma != one)
+                            backend::axpby(math::inverse(sigma), *v[j+i], zero, *v[j+i]);
+                    }
+
+                    // -- Orthogonalization of the block, two reductions total.
+                    unsigned b = orthogonalize(v, *t, j, m);
+
+                    // -- Recover the new columns of the Hessenberg matrix
+                    //    and continue as in GMRES.
+                    unsigned ncols = (b < m) ? b + 1 : m;
+                    scalar_type hnorm = zero;
+
+                    for(unsigned c = 0; c < ncols; ++c) {
+                        unsigned k = j + c;
+
+                        hessenberg_column(j, c, sigma);
+
+                        scalar_type h = zero;
+                        for(unsigned i = 0; i <= k + 1; ++i) {
+                            Hr(i, k) = H(i, k);
+                            h += math::norm(H(i, k)) * math::norm(H(i, k));
+                        }
+                        hnorm = std::max(hnorm, sqrt(h));
+
+                        for(unsigned i = 0; i < k; ++i)
+                            detail::apply_plane_rotation(Hr(i, k), Hr(i+1, k), cs[i], sn[i]);
+
+                        detail::generate_plane_rotation(Hr(k, k), Hr(k+1, k), cs[k], sn[k]);
+                        detail::apply_plane_rotation(Hr(k, k), Hr(k+1, k), cs[k], sn[k]);
+                        detail::apply_plane_rotation(s[k], s[k+1], cs[k], sn[k]);
+
+                        scalar_type inner_res = std::abs(s[k+1]);
+
+                        ++iter;
+                        if (iter >= prm.maxiter || k + 1 >= prm.M || inner_res <= eps) {
+                            done = true;
+                            ncols = c + 1;
+                            break;
+                        }
+                    }
+
+                    j += ncols;
+
+                    // The block has been truncated: restart.
+                    if (b < m) done = true;
+
+                    if (hnorm > zero) sigma = hnorm;
+                }
+
+                // -- GMRES terminated: eval solution
+                for (unsigned i = j; i --> 0; ) {
+                    s[i] /= Hr(i, i);
+                    for (unsigned k = 0; k < i; ++k)
+                        s[k] -= Hr(k, i) * s[i];
+                }
+
+                // -- Apply step
+                vector &dx = *r;
+                backend::lin_comb(j, s, v, zero, dx);
+
+                if (prm.pside == side::left) {
+                    backend::axpby(one, dx, one, x);
+                } else {
+                    vector &tmp = *v[0];
+                    P.apply(dx, tmp);
+                    backend::axpby(one, tmp, one, x);
+                }
+            }
+
+            return std::make_tuple(iter, norm_r / norm_rhs);
+        }
+
+        /* Computes the solution for the given right-hand side \p rhs. The
+         * system matrix is the same that was used for the setup of the
+         * preconditioner \p P.  Returns the number of iterations made and the
+         * achieved residual as a ``std::tuple``. The solution vector \p x
+         * provides initial approximation in input and holds the computed
+         * solution on output.
+         */
+        template <class Precond, class Vec1, class Vec2>
+        std::tuple<size_t, scalar_type> operator()(
+                Precond const &P,
+                Vec1    const &rhs,
+                Vec2          &x
+                ) const
+        {
+            return (*this)(P.system_matrix(), P, rhs, x);
+        }
+
+        friend std::ostream& operator<<(std::ostream &os, const ca_gmres &s) {
+            return os
+                << "Type:             CA-GMRES(" << s.prm.M << ", " << s.prm.s << ")"
+                << "\nUnknowns:         " << s.n
+                << "\nMemory footprint: " << human_readable_memory(s.bytes())
+                << std::endl;
+        }
+    public:
+        params prm;
+
+        size_t bytes() const {
+            size_t b = 0;
+
+            b += H.size()  * sizeof(coef_type);
+            b += Hr.size() * sizeof(coef_type);
+            b += C.size()  * sizeof(coef_type);
+            b += R.size()  * sizeof(coef_type);
+            b += G.size()  * sizeof(coef_type);
+            b += backend::bytes(s);
+            b += backend::bytes(cs);
+            b += backend::bytes(sn);
+            b += backend::bytes(work);
+            b += backend::bytes(basis);
+
+            return b;
+        }
+    private:
+        size_t n;
+
+        // H is the Hessenberg matrix, Hr is its rotated (triangular) copy.
+        mutable multi_array<coef_type, 2> H, Hr;
+
+        // Block orthogonalization coefficients: v[j+1..j+m] = v[0..j] C + Q R,
+        // where Q are the new orthonormal vectors.
+        mutable multi_array<coef_type, 2> C, R, G;
+
+        mutable std::vector<coef_type> s, cs, sn, buf;
+        backend::work_vectors<Backend> work, basis;
+
+        InnerProduct inner_product;
+
+        template <class Vec>
+        scalar_type norm(const Vec &x) const {
+            return std::abs(sqrt(inner_product(x, x)));
+        }
+
+        // Orthonormalizes v[j+1..j+m] against v[0..j] and each other.
+        // Returns the number of new basis vectors (m unless there was a
+        // breakdown). t is used as a temporary.
+        unsigned orthogonalize(const vector_set &v, vector &t, unsigned j, unsigned m) const {
+            static const scalar_type one  = math::identity<scalar_type>();
+            static const coef_type   zero = math::zero<coef_type>();
+
+            const unsigned nc = (j + 1) * m;
+            const unsigned ng = m * (m + 1) / 2;
+
+            // First pass of the block CGS. The norms of the raw vectors are
+            // collected as a reference for the breakdown check.
+            buf.resize(nc + m);
+            for(unsigned i = 0; i < m; ++i) {
+                for(unsigned k = 0; k <= j; ++k)
+                    buf[i * (j + 1) + k] = local_dot(*v[j+1+i], *v[k]);
+                buf[nc + i] = local_dot(*v[j+1+i], *v[j+1+i]);
+            }
+            detail::start_reduction(inner_product, buf.data(), nc + m, 0).wait();
+
+            std::vector<scalar_type> wnorm(m);
+            for(unsigned i = 0; i < m; ++i) {
+                wnorm[i] = std::abs(buf[nc + i]);
+                for(unsigned k = 0; k <= j; ++k)
+                    C(k, i) = buf[i * (j + 1) + k];
+                project(v, j + 1, &buf[i * (j + 1)], *v[j+1+i], t);
+            }
+
+            // Second pass, along with the Gram matrix of the block.
+            buf.resize(nc + ng);
+            for(unsigned i = 0, p = nc; i < m; ++i) {
+                for(unsigned k = 0; k <= j; ++k)
+                    buf[i * (j + 1) + k] = local_dot(*v[j+1+i], *v[k]);
+                for(unsigned k = 0; k <= i; ++k, ++p)
+                    buf[p] = local_dot(*v[j+1+i], *v[j+1+k]);
+            }
+            detail::start_reduction(inner_product, buf.data(), nc + ng, 0).wait();
+
+            // The Gram matrix after the second pass is G - C2^H C2, since the
+            // vectors being projected out are orthonormal.
+            for(unsigned i = 0, p = nc; i < m; ++i) {
+                const coef_type *ci = &buf[i * (j + 1)];
+                for(unsigned k = 0; k <= i; ++k, ++p) {
+                    const coef_type *ck = &buf[k * (j + 1)];
+                    coef_type g = buf[p];
+                    for(unsigned l = 0; l <= j; ++l)
+                        g -= math::adjoint(ck[l]) * ci[l];
+                    G(k, i) = g;
+                    G(i, k) = math::adjoint(g);
+                }
+            }
+
+            for(unsigned i = 0; i < m; ++i) {
+                for(unsigned k = 0; k <= j; ++k)
+                    C(k, i) += buf[i * (j + 1) + k];
+                project(v, j + 1, &buf[i * (j + 1)], *v[j+1+i], t);
+            }
+
+            // Cholesky QR of the block: G = R^H R.
+            unsigned b = m;
+            for(unsigned i = 0; i < m; ++i) {
+                for(unsigned k = 0; k < i; ++k) R(i, k) = zero;
+
+                coef_type d = G(i, i);
+                for(unsigned k = 0; k < i; ++k)
+                    d -= math::adjoint(R(k, i)) * R(k, i);
+
+                scalar_type dr = std::real(d);
+                if (!(dr > amgcl::detail::eps<scalar_type>(m) * wnorm[i])) {
+                    for(unsigned k = i; k < m; ++k) R(i, k) = zero;
+                    b = i;
+                    break;
+                }
+
+                R(i, i) = sqrt(dr);
+                for(unsigned k = i + 1; k < m; ++k) {
+                    coef_type g = G(i, k);
+                    for(unsigned l = 0; l < i; ++l)
+                        g -= math::adjoint(R(l, i)) * R(l, k);
+                    R(i, k) = g / R(i, i);
+                }
+            }
+
+            // v[j+1..j+b] := v[j+1..j+b] R^{-1}
+            for(unsigned i = 0; i < b; ++i) {
+                for(unsigned k = 0; k < i; ++k)
+                    backend::axpby(-R(k, i), *v[j+1+k], one, *v[j+1+i]);
+                backend::axpby(math::inverse(R(i, i)), *v[j+1+i], math::zero<scalar_type>(), *v[j+1+i]);
+            }
+
+            return b;
+        }
+
+        template <class Vec1, class Vec2>
+        coef_type local_dot(const Vec1 &x, const Vec2 &y) const {
+            return detail::local_inner_product(inner_product, x, y, 0);
+        }
+
+        // y -= v[0..n-1] c[0..n-1]
+        void project(const vector_set &v, unsigned n, const coef_type *c, vector &y, vector &t) const {
+            static const scalar_type one  = math::identity<scalar_type>();
+            static const scalar_type zero = math::zero<scalar_type>();
+
+            backend::lin_comb(n, c, v, zero, t);
+            backend::axpby(-one, t, one, y);
+        }
+
+        // Coefficient of the k-th basis vector in the i-th (zero-based)
+        // vector of the monomial block started at v[j].
+        coef_type block_coef(unsigned j, unsigned k, unsigned i) const {
+            if (i == 0) return k == j ? math::identity<coef_type>() : math::zero<coef_type>();
+            if (k <= j) return C(k, i - 1);
+            if (k - j - 1 < i) return R(k - j - 1, i - 1);
+            return math::zero<coef_type>();
+        }
+
+        // Column j+c of the Hessenberg matrix from op W_{0..m-1} = sigma W_{1..m}
+        // and W = V B, which gives H B_{0..m-1} = sigma B_{1..m}.
+        void hessenberg_column(unsigned j, unsigned c, scalar_type sigma) const {
+            unsigned k = j + c;
+
+            for(unsigned i = 0; i <= k + 1; ++i) {
+                coef_type h = sigma * block_coef(j, i, c + 1);
+                for(unsigned l = (c ? 0 : j); l < k; ++l) {
+                    if (i > l + 1) continue;
+                    h -= H(i, l) * block_coef(j, l, c);
+                }
+                H(i, k) = h;
+            }
+
+            coef_type d = block_coef(j, k, c);
+            for(unsigned i = 0; i <= k + 1; ++i)
+                H(i, k) = H(i, k) / d;
+
+            for(unsigned i = k + 2; i <= prm.M; ++i)
+                H(i, k) = math::zero<coef_type>();
+        }
+};
+
+} // namespace solver
+} // namespace amgcl
+
+#endif
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include <tuple>
 #include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/workspace.hpp>
 #include <amgcl/solver/detail/default_inner_product.hpp>
 #include <amgcl/util.hpp>
 
@@ -73,7 +74,7 @@ class cg {
         typedef typename math::scalar_of<value_type>::type scalar_type;
 
         typedef typename math::inner_product_impl<
-            typename math::rhs_of<value_type>::type
+            typename backend::vector_value_type<Backend>::type
             >::return_type coef_type;
 
         /// Solver parameters.
@@ -116,10 +117,7 @@ class cg {
                 const backend_params &backend_prm = backend_params(),
                 const InnerProduct &inner_product = InnerProduct()
           ) : prm(prm), n(n),
-              r(Backend::create_vector(n, backend_prm)),
-              s(Backend::create_vector(n, backend_prm)),
-              p(Backend::create_vector(n, backend_prm)),
-              q(Backend::create_vector(n, backend_prm)),
+              work(4, n, backend_prm),
               inner_product(inner_product)
         { }
 
@@ -142,22 +140,26 @@ class cg {
             static const coef_type one  = math::identity<coef_type>();
             static const coef_type zero = math::zero<coef_type>();
 
-            scalar_type norm_rhs = norm(rhs);
+            const coef_type rhs2 = inner_product(rhs, rhs);
+            scalar_type norm_rhs = sqrt(math::norm(rhs2));
             if (norm_rhs < amgcl::detail::eps<scalar_type>(1)) {
                 backend::clear(x);
                 return std::make_tuple(0, norm_rhs);
             }
 
-            scalar_type eps = std::max(prm.tol * norm_rhs, prm.abstol);
-
-            coef_type rho1 = 2 * eps * one;
+            coef_type rho1 = 2 * std::max(prm.tol * norm_rhs, prm.abstol) * one;
             coef_type rho2 = zero;
 
+            auto w = work.get();
+            const std::shared_ptr<vector> &r = w[0], &s = w[1], &p = w[2], &q = w[3];
+
             backend::residual(rhs, A, x, *r);
-            scalar_type res_norm = norm(*r);
+
+            scalar_type res;
+            bool done = converged(inner_product(*r, *r), rhs2, res);
 
             size_t iter = 0;
-            for(; iter < prm.maxiter && math::norm(res_norm) > eps; ++iter) {
+            for(; iter < prm.maxiter && !done; ++iter) {
                 P.apply(*r, *s);
 
                 rho2 = rho1;
@@ -175,10 +177,10 @@ class cg {
                 backend::axpby( alpha, *p, one,  x);
                 backend::axpby(-alpha, *q, one, *r);
 
-                res_norm = norm(*r);
+                done = converged(inner_product(*r, *r), rhs2, res);
             }
 
-            return std::make_tuple(iter, res_norm / norm_rhs);
+            return std::make_tuple(iter, res);
         }
 
         /* Computes the solution for the given right-hand side \p rhs. The
@@ -196,11 +198,7 @@ class cg {
         }
 
         size_t bytes() const {
-            return
-                backend::bytes(*r) +
-                backend::bytes(*s) +
-                backend::bytes(*p) +
-                backend::bytes(*q);
+            return backend::bytes(work);
         }
 
         friend std::ostream& operator<<(std::ostream &os, const cg &s) {
@@ -216,16 +214,17 @@ class cg {
     private:
         size_t n;
 
-        std::shared_ptr<vector> r;
-        std::shared_ptr<vector> s;
-        std::shared_ptr<vector> p;
-        std::shared_ptr<vector> q;
+        backend::work_vectors<Backend> work;
 
         InnerProduct inner_product;
 
-        template <class Vec>
-        scalar_type norm(const Vec &x) const {
-            return sqrt(math::norm(inner_product(x, x)));
+        // Checks the residual against the tolerances given the inner products
+        // r2 = (r,r) and f2 = (rhs,rhs), and returns the relative residual.
+        // The relative residual of a multi_rhs vector is the largest one of
+        // its systems.
+        bool converged(const coef_type &r2, const coef_type &f2, scalar_type &res) const {
+            res = math::relative_norm(r2, f2);
+            return res <= prm.tol || sqrt(math::norm(r2)) <= prm.abstol;
         }
 };
 
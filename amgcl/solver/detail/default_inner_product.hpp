@@ -47,8 +47,68 @@ struct default_inner_product {
     operator()(const Vec1 &x, const Vec2 &y) const {
         return backend::inner_product(x, y);
     }
+
+    /// Local part of the inner product (which is the complete product here).
+    template <class Vec1, class Vec2>
+    typename math::inner_product_impl<
+        typename backend::value_type<Vec1>::type
+    >::return_type
+    local(const Vec1 &x, const Vec2 &y) const {
+        return backend::inner_product(x, y);
+    }
+
+    /// Handle for the pending reduction started with ireduce().
+    struct request {
+        void wait() {}
+    };
+
+    /// Starts the summation of the local parts of inner products.
+    /**
+     * The n values in v are replaced with their sums over all of the
+     * participating processes once wait() is called on the returned request.
+     * This is a noop for the shared memory case.
+     */
+    template <class T>
+    request ireduce(T*, int) const {
+        return request();
+    }
+};
+
+/* Inner products that provide local() and ireduce() (see
+ * default_inner_product) allow to overlap the global reduction with local
+ * work, or to combine several reductions into one. Other inner products are
+ * used as is, and the reduction is then a noop.
+ */
+struct blocking_reduction {
+    void wait() {}
 };
 
+template <class IP, class Vec1, class Vec2>
+auto local_inner_product(const IP &ip, const Vec1 &x, const Vec2 &y, int)
+    -> decltype(ip.local(x, y))
+{
+    return ip.local(x, y);
+}
+
+template <class IP, class Vec1, class Vec2>
+auto local_inner_product(const IP &ip, const Vec1 &x, const Vec2 &y, long)
+    -> decltype(ip(x, y))
+{
+    return ip(x, y);
+}
+
+template <class IP, class T>
+auto start_reduction(const IP &ip, T *v, int n, int)
+    -> decltype(ip.ireduce(v, n))
+{
+    return ip.ireduce(v, n);
+}
+
+template <class IP, class T>
+blocking_reduction start_reduction(const IP&, T*, int, long) {
+    return blocking_reduction();
+}
+
 } // namespace detail
 } // namespace solver
 } // namespace amgcl
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include <tuple>
 
 #include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/workspace.hpp>
 #include <amgcl/solver/detail/default_inner_product.hpp>
 #include <amgcl/solver/detail/givens_rotations.hpp>
 #include <amgcl/util.hpp>
@@ -61,6 +62,8 @@ class fgmres {
         typedef typename Backend::value_type value_type;
         typedef typename Backend::params     backend_params;
 
+        typedef typename backend::work_vectors<Backend>::vector_set vector_set;
+
         typedef typename math::scalar_of<value_type>::type scalar_type;
         typedef typename math::rhs_of<value_type>::type rhs_type;
         typedef typename math::inner_product_impl<rhs_type>::return_type coef_type;
@@ -113,17 +116,9 @@ class fgmres {
             : prm(prm), n(n),
               H(prm.M + 1, prm.M),
               s(prm.M + 1), cs(prm.M + 1), sn(prm.M + 1),
-              r( Backend::create_vector(n, bprm) ),
+              basis(prm.M + 1, n, bprm), pbasis(prm.M, n, bprm),
               inner_product(inner_product)
-        {
-            v.reserve(prm.M + 1);
-            for(unsigned i = 0; i <= prm.M; ++i)
-                v.push_back(Backend::create_vector(n, bprm));
-
-            z.reserve(prm.M);
-            for(unsigned i = 0; i < prm.M; ++i)
-                z.push_back(Backend::create_vector(n, bprm));
-        }
+        { }
 
         /* Computes the solution for the given system matrix \p A and the
          * right-hand side \p rhs.  Returns the number of iterations made and
@@ -154,6 +149,9 @@ class fgmres {
             scalar_type eps = std::max(prm.tol * norm_rhs, prm.abstol);
             scalar_type norm_r = math::zero<scalar_type>();
 
+            const vector_set v = basis.get();
+            const vector_set z = pbasis.get();
+
             unsigned iter = 0;
             while(true) {
                 backend::residual(rhs, A, x, *v[0]);
@@ -242,10 +240,8 @@ class fgmres {
             b += backend::bytes(s);
             b += backend::bytes(cs);
             b += backend::bytes(sn);
-            b += backend::bytes(*r);
-
-            for(const auto &x : v) b += backend::bytes(*x);
-            for(const auto &x : z) b += backend::bytes(*x);
+            b += backend::bytes(basis);
+            b += backend::bytes(pbasis);
 
             return b;
         }
@@ -262,9 +258,7 @@ class fgmres {
 
         mutable multi_array<coef_type, 2> H;
         mutable std::vector<coef_type> s, cs, sn;
-        std::shared_ptr<vector> r;
-        std::vector< std::shared_ptr<vector> > v;
-        std::vector< std::shared_ptr<vector> > z;
+        backend::work_vectors<Backend> basis, pbasis;
 
         InnerProduct inner_product;
 
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include <tuple>
 
 #include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/workspace.hpp>
 #include <amgcl/solver/detail/default_inner_product.hpp>
 #include <amgcl/solver/detail/givens_rotations.hpp>
 #include <amgcl/solver/precond_side.hpp>
@@ -63,6 +64,8 @@ class gmres {
         typedef typename Backend::value_type value_type;
         typedef typename Backend::params     backend_params;
 
+        typedef typename backend::work_vectors<Backend>::vector_set vector_set;
+
         typedef typename math::scalar_of<value_type>::type scalar_type;
         typedef typename math::rhs_of<value_type>::type rhs_type;
         typedef typename math::inner_product_impl<rhs_type>::return_type coef_type;
@@ -121,13 +124,9 @@ class gmres {
             : prm(prm), n(n),
               H(prm.M + 1, prm.M),
               s(prm.M + 1), cs(prm.M + 1), sn(prm.M + 1),
-              r( Backend::create_vector(n, backend_prm) ),
+              work(1, n, backend_prm), basis(prm.M + 1, n, backend_prm),
               inner_product(inner_product)
-        {
-            v.reserve(prm.M + 1);
-            for(unsigned i = 0; i <= prm.M; ++i)
-                v.push_back( Backend::create_vector(n, backend_prm) );
-        }
+        { }
 
         /* Computes the solution for the given system matrix \p A and the
          * right-hand side \p rhs.  Returns the number of iterations made and
@@ -163,6 +162,10 @@ class gmres {
             scalar_type eps = std::max(prm.tol * norm_rhs, prm.abstol);
             scalar_type norm_r = zero;
 
+            auto w = work.get();
+            const std::shared_ptr<vector> &r = w[0];
+            const vector_set v = basis.get();
+
             size_t iter = 0;
             while(true) {
                 if (prm.pside == side::left) {
@@ -272,9 +275,8 @@ class gmres {
             b += backend::bytes(s);
             b += backend::bytes(cs);
             b += backend::bytes(sn);
-            b += backend::bytes(*r);
-
-            for(const auto &x : v) b += backend::bytes(*x);
+            b += backend::bytes(work);
+            b += backend::bytes(basis);
 
             return b;
         }
@@ -283,8 +285,7 @@ class gmres {
 
         mutable multi_array<coef_type, 2> H;
         mutable std::vector<coef_type> s, cs, sn;
-        std::shared_ptr<vector> r;
-        std::vector< std::shared_ptr<vector> > v;
+        backend::work_vectors<Backend> work, basis;
 
         InnerProduct inner_product;
 
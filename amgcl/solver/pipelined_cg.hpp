@@ -0,0 +1,256 @@
+#ifndef AMGCL_SOLVERS_PIPELINED_CG_HPP
+#define AMGCL_SOLVERS_PIPELINED_CG_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/solver/pipelined_cg.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Pipelined Conjugate Gradient method.
+ */
+
+#include <tuple>
+#include <amgcl/backend/interface.hpp>
+#include <amgcl/backend/workspace.hpp>
+#include <amgcl/solver/detail/default_inner_product.hpp>
+#include <amgcl/util.hpp>
+
+namespace amgcl {
+namespace solver {
+
+/** Pipelined Conjugate Gradients method.
+ * \rst
+ * A variant of the preconditioned CG method with a single global reduction
+ * per iteration, which is overlapped with the application of the
+ * preconditioner and the matrix-vector product [GhVa14]_. In exact
+ * arithmetic the iterations are the same as in the CG method. This is
+ * beneficial in the distributed memory case, where the latency of the global
+ * reductions limits the scalability of the standard CG. The price is four
+ * more vectors, a few more vector updates, and a somewhat worse attainable
+ * accuracy due to the propagation of the rounding errors in the recurrences.
+ * \endrst
+ */
+template <
+    class Backend,
+    class InnerProduct = detail::default_inner_product
+    >
+class pipelined_cg {
+    public:
+        typedef Backend backend_type;
+
+        typedef typename Backend::vector     vector;
+        typedef typename Backend::value_type value_type;
+        typedef typename Backend::params     backend_params;
+
+        typedef typename math::scalar_of<value_type>::type scalar_type;
+
+        typedef typename math::inner_product_impl<
+            typename backend::vector_value_type<Backend>::type
+            >::return_type coef_type;
+
+        /// Solver parameters.
+        struct params {
+            /// Maximum number of iterations.
+            size_t maxiter;
+
+            /// Target relative residual error.
+            scalar_type tol;
+
+            /// Target absolute residual error.
+            scalar_type abstol;
+
+            params()
+                : maxiter(100), tol(1e-8),
+                  abstol(std::numeric_limits<scalar_type>::min())
+            {}
+
+#ifndef AMGCL_NO_BOOST
+            params(const boost::property_tree::ptree &p)
+                : AMGCL_PARAMS_IMPORT_VALUE(p, maxiter),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, tol),
+                  AMGCL_PARAMS_IMPORT_VALUE(p, abstol)
+            {
+                check_params(p, {"maxiter", "tol", "abstol"});
+            }
+
+            void get(boost::property_tree::ptree &p, const std::string &path) const {
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, maxiter);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, tol);
+                AMGCL_PARAMS_EXPORT_VALUE(p, path, abstol);
+            }
+#endif
+        };
+
+        /// Preallocates necessary data structures for the system of size \p n.
+        pipelined_cg(
+                size_t n,
+                const params &prm = params(),
+                const backend_params &backend_prm = backend_params(),
+                const InnerProduct &inner_product = InnerProduct()
+          ) : prm(prm), n(n),
+              work(9, n, backend_prm),
+              inner_product(inner_product)
+        { }
+
+        /* Computes the solution for the given system matrix \p A and the
+         * right-hand side \p rhs.  Returns the number of iterations made and
+         * the achieved residual as a ``std::tuple``. The solution vector
+         * \p x provides initial approximation in input and holds the computed
+         * solution on output.
+         *
+         * The system matrix may differ from the matrix used during
+         * initialization. This may be used for the solution of non-stationary
+         * problems with slowly changing coefficients. There is a strong chance
+         * that a preconditioner built for a time step will act as a reasonably
+         * good preconditioner for several subsequent time steps [DeSh12]_.
+         */
+        template <class Matrix, class Precond, class Vec1, class Vec2>
+        std::tuple<size_t, scalar_type> operator()(
+                const Matrix &A, const Precond &P, const Vec1 &rhs, Vec2 &&x) const
+        {
+            static const coef_type one  = math::identity<coef_type>();
+            static const coef_type zero = math::zero<coef_type>();
+
+            const coef_type rhs2 = inner_product(rhs, rhs);
+            scalar_type norm_rhs = sqrt(math::norm(rhs2));
+            if (norm_rhs < amgcl::detail::eps<scalar_type>(1)) {
+                backend::clear(x);
+                return std::make_tuple(0, norm_rhs);
+            }
+
+            scalar_type res = 0;
+
+            coef_type alpha = zero, gamma = zero;
+
+            auto wv = work.get();
+            const std::shared_ptr<vector>
+                &r = wv[0], &u = wv[1], &w = wv[2], &m = wv[3], &v = wv[4],
+                &z = wv[5], &q = wv[6], &s = wv[7], &p = wv[8];
+
+            backend::residual(rhs, A, x, *r);
+            P.apply(*r, *u);
+            backend::spmv(one, A, *u, zero, *w);
+
+            size_t iter = 0;
+            for(; iter < prm.maxiter; ++iter) {
+                // Start the reduction of (r,u), (w,u), and (r,r) ...
+                coef_type dot[3] = {
+                    detail::local_inner_product(inner_product, *r, *u, 0),
+                    detail::local_inner_product(inner_product, *w, *u, 0),
+                    detail::local_inner_product(inner_product, *r, *r, 0)
+                };
+
+                auto req = detail::start_reduction(inner_product, dot, 3, 0);
+
+                // ... and hide its latency behind the local work.
+                P.apply(*w, *m);
+                backend::spmv(one, A, *m, zero, *v);
+
+                req.wait();
+
+                if (converged(dot[2], rhs2, res)) break;
+
+                coef_type gamma_old = gamma;
+                gamma = dot[0];
+
+                if (iter) {
+                    coef_type beta = gamma / gamma_old;
+                    alpha = gamma / (dot[1] - beta * gamma / alpha);
+
+                    backend::axpby(one, *v, beta, *z);
+                    backend::axpby(one, *m, beta, *q);
+                    backend::axpby(one, *w, beta, *s);
+                    backend::axpby(one, *u, beta, *p);
+                } else {
+                    alpha = gamma / dot[1];
+
+                    backend::copy(*v, *z);
+                    backend::copy(*m, *q);
+                    backend::copy(*w, *s);
+                    backend::copy(*u, *p);
+                }
+
+                backend::axpby( alpha, *p, one,  x);
+                backend::axpby(-alpha, *s, one, *r);
+                backend::axpby(-alpha, *q, one, *u);
+                backend::axpby(-alpha, *z, one, *w);
+            }
+
+            // The residual norm lags one iteration behind the updates.
+            if (iter == prm.maxiter) converged(inner_product(*r, *r), rhs2, res);
+
+            return std::make_tuple(iter, res);
+        }
+
+        /* Computes the solution for the given right-hand side \p rhs. The
+         * system matrix is the same that was used for the setup of the
+         * preconditioner \p P.  Returns the number of iterations made and the
+         * achieved residual as a ``std::tuple``. The solution vector \p x
+         * provides initial approximation in input and holds the computed
+         * solution on output.
+         */
+        template <class Precond, class Vec1, class Vec2>
+        std::tuple<size_t, scalar_type> operator()(
+                const Precond &P, const Vec1 &rhs, Vec2 &&x) const
+        {
+            return (*this)(P.system_matrix(), P, rhs, x);
+        }
+
+        size_t bytes() const {
+            return backend::bytes(work);
+        }
+
+        friend std::ostream& operator<<(std::ostream &os, const pipelined_cg &s) {
+            return os
+                << "Type:             Pipelined CG"
+                << "\nUnknowns:         " << s.n
+                << "\nMemory footprint: " << human_readable_memory(s.bytes())
+                << std::endl;
+        }
+    public:
+        params prm;
+
+    private:
+        size_t n;
+
+        backend::work_vectors<Backend> work;
+
+        InnerProduct inner_product;
+
+        // Checks the residual against the tolerances given the inner products
+        // r2 = (r,r) and f2 = (rhs,rhs), and returns the relative residual.
+        // The relative residual of a multi_rhs vector is the largest one of
+        // its systems.
+        bool converged(const coef_type &r2, const coef_type &f2, scalar_type &res) const {
+            res = math::relative_norm(r2, f2);
+            return res <= prm.tol || sqrt(math::norm(r2)) <= prm.abstol;
+        }
+};
+
+} // namespace solver
+} // namespace amgcl
+
+
+#endif
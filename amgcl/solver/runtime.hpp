@@ -49,6 +49,8 @@ THE SOFTWARE.
 #include <amgcl/solver/lgmres.hpp>
 #include <amgcl/solver/fgmres.hpp>
 #include <amgcl/solver/idrs.hpp>
+#include <amgcl/solver/pipelined_cg.hpp>
+#include <amgcl/solver/ca_gmres.hpp>
 #include <amgcl/solver/detail/default_inner_product.hpp>
 
 namespace amgcl {
@@ -56,13 +58,15 @@ namespace runtime {
 namespace solver {
 
 enum type {
-    cg,         ///< Conjugate gradients method
-    bicgstab,   ///< BiConjugate Gradient Stabilized
-    bicgstabl,  ///< BiCGStab(ell)
-    gmres,      ///< GMRES
-    lgmres,     ///< LGMRES
-    fgmres,     ///< FGMRES
-    idrs        ///< IDR(s)
+    cg,           ///< Conjugate gradients method
+    bicgstab,     ///< BiConjugate Gradient Stabilized
+    bicgstabl,    ///< BiCGStab(ell)
+    gmres,        ///< GMRES
+    lgmres,       ///< LGMRES
+    fgmres,       ///< FGMRES
+    idrs,         ///< IDR(s)
+    pipelined_cg, ///< Pipelined conjugate gradients method
+    ca_gmres      ///< Communication-avoiding (s-step) GMRES
 };
 
 inline std::ostream& operator<<(std::ostream &os, type s)
@@ -82,6 +86,10 @@ inline std::ostream& operator<<(std::ostream &os, type s)
             return os << "fgmres";
         case idrs:
             return os << "idrs";
+        case pipelined_cg:
+            return os << "pipelined_cg";
+        case ca_gmres:
+            return os << "ca_gmres";
         default:
             return os << "???";
     }
@@ -106,9 +114,13 @@ inline std::istream& operator>>(std::istream &in, type &s)
         s = fgmres;
     else if (val == "idrs")
         s = idrs;
+    else if (val == "pipelined_cg")
+        s = pipelined_cg;
+    else if (val == "ca_gmres")
+        s = ca_gmres;
     else
         throw std::invalid_argument("Invalid solver value. Valid choices are: "
-                "cg, bicgstab, bicgstabl, gmres, lgmres, fgmres, idrs.");
+                "cg, bicgstab, bicgstabl, gmres, lgmres, fgmres, idrs, pipelined_cg, ca_gmres.");
 
     return in;
 }
@@ -149,6 +161,8 @@ struct wrapper {
             AMGCL_RUNTIME_SOLVER(lgmres);
             AMGCL_RUNTIME_SOLVER(fgmres);
             AMGCL_RUNTIME_SOLVER(idrs);
+            AMGCL_RUNTIME_SOLVER(pipelined_cg);
+            AMGCL_RUNTIME_SOLVER(ca_gmres);
 
 #undef AMGCL_RUNTIME_SOLVER
 
@@ -172,6 +186,8 @@ struct wrapper {
             AMGCL_RUNTIME_SOLVER(lgmres);
             AMGCL_RUNTIME_SOLVER(fgmres);
             AMGCL_RUNTIME_SOLVER(idrs);
+            AMGCL_RUNTIME_SOLVER(pipelined_cg);
+            AMGCL_RUNTIME_SOLVER(ca_gmres);
 
 #undef AMGCL_RUNTIME_SOLVER
         }
@@ -194,6 +210,8 @@ struct wrapper {
             AMGCL_RUNTIME_SOLVER(lgmres);
             AMGCL_RUNTIME_SOLVER(fgmres);
             AMGCL_RUNTIME_SOLVER(idrs);
+            AMGCL_RUNTIME_SOLVER(pipelined_cg);
+            AMGCL_RUNTIME_SOLVER(ca_gmres);
 
 #undef AMGCL_RUNTIME_SOLVER
 
@@ -223,6 +241,8 @@ struct wrapper {
             AMGCL_RUNTIME_SOLVER(lgmres);
             AMGCL_RUNTIME_SOLVER(fgmres);
             AMGCL_RUNTIME_SOLVER(idrs);
+            AMGCL_RUNTIME_SOLVER(pipelined_cg);
+            AMGCL_RUNTIME_SOLVER(ca_gmres);
 
 #undef AMGCL_RUNTIME_SOLVER
 
@@ -245,6 +265,8 @@ struct wrapper {
             AMGCL_RUNTIME_SOLVER(lgmres);
             AMGCL_RUNTIME_SOLVER(fgmres);
             AMGCL_RUNTIME_SOLVER(idrs);
+            AMGCL_RUNTIME_SOLVER(pipelined_cg);
+            AMGCL_RUNTIME_SOLVER(ca_gmres);
 
 #undef AMGCL_RUNTIME_SOLVER
 
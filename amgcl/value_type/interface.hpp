@@ -31,6 +31,7 @@ THE SOFTWARE.
  * \brief  Support for various value types.
  */
 
+#include <cmath>
 #include <type_traits>
 
 namespace amgcl {
@@ -98,6 +99,20 @@ struct norm_impl {
     }
 };
 
+/// Default implementation for the relative norm.
+/**
+ * Takes the inner products x2 = (x,x) and y2 = (y,y) of two vectors, and
+ * returns |x| / |y|.
+ *
+ * \note Used in relative_norm()
+ */
+template <typename ValueType, class Enable = void>
+struct relative_norm_impl {
+    static typename scalar_of<ValueType>::type get(const ValueType &x2, const ValueType &y2) {
+        return std::sqrt(norm_impl<ValueType>::get(x2) / norm_impl<ValueType>::get(y2));
+    }
+};
+
 /// Default implementation for the zero element.
 /** \note Used in zero() */
 template <typename ValueType, class Enable = void>
@@ -143,6 +158,15 @@ struct inverse_impl {
     }
 };
 
+/// Default implementation of the multiply-add operation.
+/** \note Used in mul_add() */
+template <typename MatrixType, typename VectorType, typename ResultType, class Enable = void>
+struct mul_add_impl {
+    static void apply(const MatrixType &a, const VectorType &x, ResultType &y) {
+        y += a * x;
+    }
+};
+
 /// Return conjugate transpose of argument.
 template <typename ValueType>
 typename adjoint_impl<ValueType>::return_type
@@ -163,6 +187,12 @@ typename scalar_of<ValueType>::type norm(const ValueType &a) {
     return norm_impl<ValueType>::get(a);
 }
 
+/// Relative norm |x| / |y| given the inner products x2 = (x,x) and y2 = (y,y).
+template <typename ValueType>
+typename scalar_of<ValueType>::type relative_norm(const ValueType &x2, const ValueType &y2) {
+    return relative_norm_impl<ValueType>::get(x2, y2);
+}
+
 /// Create zero element of type ValueType.
 template <typename ValueType>
 ValueType zero() {
@@ -193,6 +223,12 @@ ValueType inverse(const ValueType &x) {
     return inverse_impl<ValueType>::get(x);
 }
 
+/// Multiply-add operation: y += a * x.
+template <typename MatrixType, typename VectorType, typename ResultType>
+void mul_add(const MatrixType &a, const VectorType &x, ResultType &y) {
+    mul_add_impl<MatrixType, VectorType, ResultType>::apply(a, x, y);
+}
+
 } // namespace math
 } // namespace amgcl
 
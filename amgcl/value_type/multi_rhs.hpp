@@ -0,0 +1,291 @@
+#ifndef AMGCL_VALUE_TYPE_MULTI_RHS_HPP
+#define AMGCL_VALUE_TYPE_MULTI_RHS_HPP
+
+/*
+The MIT License
+
+Copyright (c) 2012-2020 Denis Demidov <dennis.demidov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * \file   amgcl/value_type/multi_rhs.hpp
+ * \author Denis Demidov <dennis.demidov@gmail.com>
+ * \brief  Value type holding values of several right-hand sides.
+ */
+
+#include <array>
+#include <algorithm>
+#include <iostream>
+#include <type_traits>
+
+#include <amgcl/backend/builtin.hpp>
+#include <amgcl/value_type/interface.hpp>
+
+namespace amgcl {
+
+/// Values of K independent right-hand sides (or solutions) for one unknown.
+/**
+ * A vector of these holds K vectors interleaved, so that a sparse
+ * matrix-vector product with a scalar matrix processes all of them while
+ * reading the matrix once. All of the arithmetic operations, including the
+ * inner product, are done componentwise. This makes the iterative solvers
+ * run K independent iterations in lockstep, one for each of the systems.
+ */
+template <typename T, int K>
+struct multi_rhs {
+    std::array<T, K> buf;
+
+    T operator()(int i) const {
+        return buf[i];
+    }
+
+    T& operator()(int i) {
+        return buf[i];
+    }
+
+    const T* data() const {
+        return buf.data();
+    }
+
+    T* data() {
+        return buf.data();
+    }
+
+    const multi_rhs& operator+=(const multi_rhs &y) {
+        for(int i = 0; i < K; ++i)
+            buf[i] += y.buf[i];
+        return *this;
+    }
+
+    const multi_rhs& operator-=(const multi_rhs &y) {
+        for(int i = 0; i < K; ++i)
+            buf[i] -= y.buf[i];
+        return *this;
+    }
+
+    const multi_rhs& operator*=(const multi_rhs &y) {
+        for(int i = 0; i < K; ++i)
+            buf[i] *= y.buf[i];
+        return *this;
+    }
+
+    const multi_rhs& operator*=(T c) {
+        for(int i = 0; i < K; ++i)
+            buf[i] *= c;
+        return *this;
+    }
+
+    friend multi_rhs operator*(T a, multi_rhs x) {
+        return x *= a;
+    }
+
+    friend multi_rhs operator*(multi_rhs x, T a) {
+        return x *= a;
+    }
+
+    friend multi_rhs operator-(multi_rhs x) {
+        for(int i = 0; i < K; ++i)
+            x.buf[i] = -x.buf[i];
+        return x;
+    }
+
+    friend std::ostream& operator<<(std::ostream &os, const multi_rhs &a) {
+        for(int i = 0; i < K; ++i)
+            os << " " << a(i);
+        return os;
+    }
+};
+
+template <typename T, int K>
+multi_rhs<T, K> operator+(multi_rhs<T, K> a, const multi_rhs<T, K> &b) {
+    return a += b;
+}
+
+template <typename T, int K>
+multi_rhs<T, K> operator-(multi_rhs<T, K> a, const multi_rhs<T, K> &b) {
+    return a -= b;
+}
+
+template <typename T, int K>
+multi_rhs<T, K> operator*(multi_rhs<T, K> a, const multi_rhs<T, K> &b) {
+    return a *= b;
+}
+
+/// Componentwise division.
+/**
+ * Components with zero denominator are set to zero. This happens when one
+ * of the systems has already converged exactly while the others are still
+ * iterating, and keeps it from polluting the solution with NaNs.
+ */
+template <typename T, int K>
+multi_rhs<T, K> operator/(multi_rhs<T, K> a, const multi_rhs<T, K> &b) {
+    for(int i = 0; i < K; ++i)
+        a(i) = math::is_zero(b(i)) ? math::zero<T>() : a(i) / b(i);
+    return a;
+}
+
+namespace backend {
+
+template <typename T, int K>
+struct is_builtin_vector< std::vector< multi_rhs<T, K> > > : std::true_type {};
+
+} // namespace backend
+
+namespace math {
+
+/// Scalar type of a non-scalar type.
+template <class T, int K>
+struct scalar_of< multi_rhs<T, K> > {
+    typedef typename scalar_of<T>::type type;
+};
+
+/// Replace scalar type in the multi_rhs.
+template <class T, int K, class S>
+struct replace_scalar<multi_rhs<T, K>, S> {
+    typedef multi_rhs<S, K> type;
+};
+
+/// Componentwise conjugate.
+template <typename T, int K>
+struct adjoint_impl< multi_rhs<T, K> >
+{
+    typedef multi_rhs<T, K> return_type;
+
+    static multi_rhs<T, K> get(multi_rhs<T, K> x) {
+        for(int i = 0; i < K; ++i)
+            x(i) = math::adjoint(x(i));
+        return x;
+    }
+};
+
+/// Componentwise inner product.
+/**
+ * Inner product of two block vectors is a set of K inner products of the
+ * individual vectors.
+ */
+template <class T, int K>
+struct inner_product_impl< multi_rhs<T, K> >
+{
+    typedef multi_rhs<T, K> return_type;
+
+    static return_type get(const multi_rhs<T, K> &x, const multi_rhs<T, K> &y) {
+        multi_rhs<T, K> p;
+        for(int i = 0; i < K; ++i)
+            p(i) = x(i) * math::adjoint(y(i));
+        return p;
+    }
+};
+
+/// Largest norm of the components.
+/**
+ * The norm of a block vector is then the largest norm of the individual
+ * vectors. The iterative solvers check it against the absolute tolerance.
+ */
+template <typename T, int K>
+struct norm_impl< multi_rhs<T, K> >
+{
+    static typename math::scalar_of<T>::type get(const multi_rhs<T, K> &x) {
+        typename math::scalar_of<T>::type s = 0;
+        for(int i = 0; i < K; ++i)
+            s = std::max(s, math::norm(x(i)));
+        return s;
+    }
+};
+
+/// Largest relative norm of the components.
+/**
+ * The iterative solvers check the relative residual against the tolerance,
+ * so that each of the systems has to converge relative to its own
+ * right-hand side, whatever the magnitudes of the others. A system with zero
+ * right-hand side is measured by its absolute residual.
+ */
+template <typename T, int K>
+struct relative_norm_impl< multi_rhs<T, K> >
+{
+    static typename math::scalar_of<T>::type get(
+            const multi_rhs<T, K> &x2, const multi_rhs<T, K> &y2)
+    {
+        typename math::scalar_of<T>::type s = 0;
+        for(int i = 0; i < K; ++i) {
+            if (math::is_zero(y2(i)))
+                s = std::max(s, std::sqrt(math::norm(x2(i))));
+            else
+                s = std::max(s, math::relative_norm(x2(i), y2(i)));
+        }
+        return s;
+    }
+};
+
+template <typename T, int K>
+struct zero_impl< multi_rhs<T, K> >
+{
+    static multi_rhs<T, K> get() {
+        multi_rhs<T, K> z;
+        for(int i = 0; i < K; ++i)
+            z(i) = math::zero<T>();
+        return z;
+    }
+};
+
+template <typename T, int K>
+struct is_zero_impl< multi_rhs<T, K> >
+{
+    static bool get(const multi_rhs<T, K> &x) {
+        for(int i = 0; i < K; ++i)
+            if (!math::is_zero(x(i))) return false;
+        return true;
+    }
+};
+
+template <typename T, int K>
+struct identity_impl< multi_rhs<T, K> >
+{
+    static multi_rhs<T, K> get() {
+        multi_rhs<T, K> I;
+        for(int i = 0; i < K; ++i)
+            I(i) = math::identity<T>();
+        return I;
+    }
+};
+
+template <typename T, int K>
+struct constant_impl< multi_rhs<T, K> >
+{
+    static multi_rhs<T, K> get(typename scalar_of<T>::type c) {
+        multi_rhs<T, K> C;
+        for(int i = 0; i < K; ++i)
+            C(i) = math::constant<T>(c);
+        return C;
+    }
+};
+
+template <typename T, int K>
+struct inverse_impl< multi_rhs<T, K> >
+{
+    static multi_rhs<T, K> get(const multi_rhs<T, K> &x) {
+        return math::identity< multi_rhs<T, K> >() / x;
+    }
+};
+
+} // namespace math
+} // namespace amgcl
+
+#endif
@@ -175,6 +175,11 @@ namespace backend {
 template <typename T, int N, int M>
 struct is_builtin_vector< std::vector<static_matrix<T, N, M> > > : std::true_type {};
 
+template <typename T, int N, int M>
+struct single_precision< builtin< static_matrix<T, N, M> > > {
+    typedef builtin< static_matrix<float, N, M> > type;
+};
+
 } // namespace backend
 
 namespace math {
@@ -328,6 +333,30 @@ struct inverse_impl< static_matrix<T, N, N> >
     }
 };
 
+/// Specialization of matrix-vector multiply-add for static matrices.
+/**
+ * Accumulates the product directly into the result, avoiding the temporary
+ * created by operator*. This is the inner operation of the block spmv and
+ * residual kernels.
+ */
+template <typename T, int N>
+struct mul_add_impl< static_matrix<T, N, N>, static_matrix<T, N, 1>, static_matrix<T, N, 1> >
+{
+    static void apply(
+            const static_matrix<T, N, N> &a,
+            const static_matrix<T, N, 1> &x,
+            static_matrix<T, N, 1> &y
+            )
+    {
+        for(int i = 0; i < N; ++i) {
+            T sum = y(i);
+            for(int j = 0; j < N; ++j)
+                sum += a(i,j) * x(j);
+            y(i) = sum;
+        }
+    }
+};
+
 
 } // namespace math
 } // namespace amgcl
@@ -1,5 +1,6 @@
 import numpy
 import scipy
+import scipy.sparse
 from . import pyamgcl_ext
 from scipy.sparse.linalg import LinearOperator
 
@@ -14,7 +15,7 @@ class solver(pyamgcl_ext.solver):
     def __repr__(self):
         return self.P.__repr__()
 
-    def __call__(self, *args):
+    def __call__(self, *args, x=None):
         """
         Solves the system for the given system matrix and the right-hand side.
 
@@ -30,16 +31,22 @@ class solver(pyamgcl_ext.solver):
         approximate the system matrix.  This saves time needed for rebuilding
         the preconditioner.
 
+        When the solution vector x is given, it is used as the initial
+        approximation, and is overwritten with the solution in place. It
+        should be a contiguous float64 array. Otherwise, a new array is
+        returned, and the initial approximation is zero.
+
         Parameters
         ----------
         A : the new system matrix (optional)
         rhs : the right-hand side
+        x : the solution vector (optional)
         """
         if len(args) == 1:
-            return pyamgcl_ext.solver.__call__(self, args[0])
+            return pyamgcl_ext.solver.__call__(self, args[0], x)
         elif len(args) == 2:
-            Acsr = args[0].tocsr()
-            return pyamgcl_ext.solver.__call__(self, Acsr.indptr, Acsr.indices, Acsr.data, args[1])
+            ptr, col, val = csr_arrays(args[0])
+            return pyamgcl_ext.solver.__call__(self, ptr, col, val, args[1], x)
         else:
             raise "Wrong number of arguments"
 
@@ -56,7 +63,35 @@ class amgcl(pyamgcl_ext.amgcl):
         A     The system matrix in scipy.sparse format
         prm   Dictionary with amgcl parameters
         """
-        Acsr = A.tocsr()
         self.shape = A.shape
 
-        pyamgcl_ext.amgcl.__init__(self, Acsr.indptr, Acsr.indices, Acsr.data, prm)
+        ptr, col, val = csr_arrays(A)
+        pyamgcl_ext.amgcl.__init__(self, ptr, col, val, prm)
+
+    def rebuild(self, A):
+        """
+        Rebuilds the hierarchy for the new values of the system matrix.
+
+        The sparsity pattern should be the same as the one of the matrix
+        used on construction, and 'allow_rebuild' should be set in the
+        parameters. The coarsening is not repeated.
+
+        Parameters
+        ----------
+        A     The new system matrix in scipy.sparse format, or the array of
+              its nonzero values in CSR order
+        """
+        if scipy.sparse.issparse(A):
+            A = A.tocsr().data
+        pyamgcl_ext.amgcl.rebuild(self, A)
+
+def csr_arrays(A):
+    """
+    Returns the CSR arrays of the matrix. The arrays are passed to the
+    extension without copying, unless the index arrays have different types.
+    """
+    Acsr = A.tocsr()
+    ptr, col = Acsr.indptr, Acsr.indices
+    if ptr.dtype != col.dtype:
+        ptr, col = ptr.astype(numpy.int64), col.astype(numpy.int64)
+    return ptr, col, Acsr.data
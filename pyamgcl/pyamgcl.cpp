@@ -2,6 +2,7 @@
 #include <string>
 #include <sstream>
 #include <cstring>
+#include <cstdint>
 
 #include <boost/range/iterator_range.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -23,56 +24,92 @@ profiler<> prof;
 
 namespace py = pybind11;
 
+// Contiguous array. Arrays of other types or layouts are converted (copied)
+// on input, arrays of the right type and layout are used in place.
+template <typename T>
+using carray = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
 //---------------------------------------------------------------------------
 boost::property_tree::ptree make_ptree(const py::dict &args) {
     boost::property_tree::ptree prm;
-    for(auto p : args)
-        prm.put(static_cast<std::string>(py::str(p.first)),
-                static_cast<std::string>(py::str(p.second)));
+    for(auto p : args) {
+        std::string key = py::str(p.first);
+        if (py::isinstance<py::bool_>(p.second))
+            prm.put(key, p.second.cast<bool>());
+        else
+            prm.put(key, static_cast<std::string>(py::str(p.second)));
+    }
     return prm;
 }
 
 //---------------------------------------------------------------------------
 template <typename T>
-py::array_t<T> make_array(size_t n, T *ptr = nullptr) {
-    return py::array_t<T>(
-            py::buffer_info(
-                ptr, sizeof(T), py::format_descriptor<T>::value, 1, {n}, {sizeof(T)}
-                )
-            );
+boost::iterator_range<const T*> make_range(const carray<T> &a) {
+    amgcl::precondition(a.ndim() == 1,
+            "Got multidimensional array for a vector parameter");
+
+    return boost::make_iterator_range(a.data(), a.data() + a.shape(0));
 }
 
 //---------------------------------------------------------------------------
-template <typename T>
-boost::iterator_range<T*> make_range(py::array_t<T> a) {
-    py::buffer_info i = a.request();
-
-    amgcl::precondition(i.ndim == 1,
-            "Got multidimensional array for a vector parameter");
+// Returns the array to write the result to. This is either the array given
+// by the user (which should be a contiguous float64 vector of size n, so that
+// it may be written in place), or a new array. The user array is borrowed
+// as is, without a conversion, so the returned object is the same one.
+carray<double> output_array(py::object x, size_t n) {
+    if (x.is_none()) return carray<double>(n);
+
+    amgcl::precondition(py::isinstance<carray<double>>(x),
+            "Output should be a contiguous float64 vector");
+
+    auto y = py::reinterpret_borrow<carray<double>>(x);
+
+    amgcl::precondition(y.ndim() == 1,
+            "Output should be a contiguous float64 vector");
+    amgcl::precondition(y.writeable(),
+            "Output vector is not writeable");
+    amgcl::precondition(static_cast<size_t>(y.shape(0)) == n,
+            "Output vector has wrong size");
+
+    return y;
+}
 
-    return boost::make_iterator_range(
-            static_cast<T*>(i.ptr), static_cast<T*>(i.ptr) + i.shape[0]
-            );
+template <typename T>
+boost::iterator_range<T*> make_output_range(carray<T> &a) {
+    T *p = a.mutable_data();
+    return boost::make_iterator_range(p, p + a.shape(0));
 }
 
 //---------------------------------------------------------------------------
 struct precond {
     typedef amgcl::backend::builtin<double> backend_type;
     typedef backend_type::matrix matrix;
-    typedef backend_type::vector vector;
+    typedef boost::iterator_range<const double*> crange;
     typedef boost::iterator_range<double*> range;
 
-    virtual void apply(const vector& rhs, vector &x) const = 0;
+    virtual void apply(const crange &rhs, range &x) const = 0;
     virtual const matrix& system_matrix() const = 0;
     virtual std::string repr() const = 0;
 
     const precond& matvec() const { return *this; }
 
-    py::array_t<double> call(py::array_t<double> rhs) const {
-        vector x(rhs.size(), true);
-        vector f(rhs.data(), rhs.data() + rhs.size());
-        this->apply(f, x);
-        return make_array(x.size(), x.data());
+    template <class Vec1, class Vec2>
+    void apply(const Vec1 &rhs, Vec2 &&x) const {
+        range y(&x[0], &x[0] + x.size());
+        this->apply(crange(&rhs[0], &rhs[0] + rhs.size()), y);
+    }
+
+    carray<double> call(carray<double> rhs, py::object x) const {
+        auto f = make_range(rhs);
+        auto y = output_array(x, f.size());
+        auto u = make_output_range(y);
+
+        {
+            py::gil_scoped_release release;
+            this->apply(f, u);
+        }
+
+        return y;
     }
 };
 
@@ -85,11 +122,13 @@ class solver
             : S(amgcl::backend::rows(P.system_matrix()), make_ptree(prm)), P(P)
         {}
 
-        py::array_t<double> solve(
-                py::array_t<int>    _ptr,
-                py::array_t<int>    _col,
-                py::array_t<double> _val,
-                py::array_t<double> _rhs
+        template <typename Idx>
+        carray<double> solve(
+                carray<Idx>    _ptr,
+                carray<Idx>    _col,
+                carray<double> _val,
+                carray<double> _rhs,
+                py::object     _x
                 ) const
         {
             auto ptr = make_range(_ptr);
@@ -97,23 +136,34 @@ class solver
             auto val = make_range(_val);
             auto rhs = make_range(_rhs);
 
-            size_t n = boost::size(rhs);
-            std::vector<double> x(n, 0.0);
+            size_t n = rhs.size();
 
-            std::tie(iters, error) = (*this)(
-                    std::make_tuple(n, ptr, col, val), P,
-                    std::vector<double>(boost::begin(rhs), boost::end(rhs)), x
-                    );
+            auto y = output_array(_x, n);
+            auto x = make_output_range(y);
+            if (_x.is_none()) std::fill(x.begin(), x.end(), 0.0);
 
-            return make_array(x.size(), x.data());
+            {
+                py::gil_scoped_release release;
+                std::tie(iters, error) = (*this)(
+                        std::make_tuple(n, ptr, col, val), P, rhs, x);
+            }
+
+            return y;
         }
 
-        py::array_t<double> solve(py::array_t<double> _rhs) const {
+        carray<double> solve(carray<double> _rhs, py::object _x) const {
             auto rhs = make_range(_rhs);
-            std::vector<double> x(boost::size(rhs), 0.0);
-            std::tie(iters, error) = (*this)(
-                    P, std::vector<double>(boost::begin(rhs), boost::end(rhs)), x);
-            return make_array(x.size(), x.data());
+
+            auto y = output_array(_x, rhs.size());
+            auto x = make_output_range(y);
+            if (_x.is_none()) std::fill(x.begin(), x.end(), 0.0);
+
+            {
+                py::gil_scoped_release release;
+                std::tie(iters, error) = (*this)(P, rhs, x);
+            }
+
+            return y;
         }
 
         int iterations() const {
@@ -138,24 +188,28 @@ template <class Precond>
 class amg_precond: public precond
 {
     public:
-        amg_precond(
-            py::array_t<int>    _ptr,
-            py::array_t<int>    _col,
-            py::array_t<double> _val,
-            py::dict prm
-           )
+        // The index arrays are referenced (not copied), and are kept for
+        // rebuild().
+        template <typename Idx>
+        amg_precond(carray<Idx> ptr, carray<Idx> col, carray<double> val, py::dict prm)
+            : ptr(ptr), col(col)
         {
-            auto ptr = make_range(_ptr);
-            auto col = make_range(_col);
-            auto val = make_range(_val);
+            auto p = make_ptree(prm);
+            auto A = make_matrix<Idx>(val);
 
-            P = std::make_shared<Precond>(
-                    std::make_tuple(boost::size(ptr) - 1, ptr, col, val),
-                    make_ptree(prm)
-                    );
+            py::gil_scoped_release release;
+            P = std::make_shared<Precond>(A, p);
         }
 
-        void apply(const precond::vector& rhs, precond::vector &x) const {
+        /// Rebuilds the preconditioner for new matrix values.
+        void rebuild(carray<double> val) {
+            if (ptr.dtype().itemsize() == sizeof(int32_t))
+                do_rebuild<int32_t>(val);
+            else
+                do_rebuild<int64_t>(val);
+        }
+
+        void apply(const crange &rhs, range &x) const {
             P->apply(rhs, x);
         }
 
@@ -170,7 +224,34 @@ class amg_precond: public precond
         }
 
     private:
+        py::array ptr, col;
         std::shared_ptr<Precond> P;
+
+        template <typename Idx>
+        std::tuple<
+            size_t,
+            boost::iterator_range<const Idx*>,
+            boost::iterator_range<const Idx*>,
+            boost::iterator_range<const double*>
+            >
+        make_matrix(const carray<double> &val) const {
+            auto p = make_range(carray<Idx>::ensure(ptr));
+            auto c = make_range(carray<Idx>::ensure(col));
+            auto v = make_range(val);
+
+            amgcl::precondition(v.size() == c.size(),
+                    "Values array has wrong size");
+
+            return std::make_tuple(p.size() - 1, p, c, v);
+        }
+
+        template <typename Idx>
+        void do_rebuild(const carray<double> &val) {
+            auto A = make_matrix<Idx>(val);
+
+            py::gil_scoped_release release;
+            P->rebuild(A);
+        }
 };
 
 //---------------------------------------------------------------------------
@@ -178,15 +259,25 @@ PYBIND11_MODULE(pyamgcl_ext, m) {
     py::class_<precond> Precond(m, "precond");
     Precond
         .def("__repr__", &precond::repr)
-        .def("__call__", &precond::call, "Applies preconditioner to the given vector", py::arg("rhs"))
+        .def("__call__", &precond::call,
+                "Applies preconditioner to the given vector",
+                py::arg("rhs"), py::arg("x") = py::none())
         .def_property_readonly("matvec", &precond::matvec);
         ;
 
     typedef amgcl::backend::builtin<double> Backend;
 
     typedef amg_precond<amgcl::runtime::preconditioner<Backend>> AMG;
+
+    // Index arrays of the exact type are used in place. Anything else is
+    // converted by the first overload, so the int64 ones go first to
+    // avoid truncation.
     py::class_<AMG>(m, "amgcl", Precond)
-        .def(py::init<py::array_t<int>, py::array_t<int>, py::array_t<double>, py::dict>());
+        .def(py::init<carray<int64_t>, carray<int64_t>, carray<double>, py::dict>())
+        .def(py::init<carray<int32_t>, carray<int32_t>, carray<double>, py::dict>())
+        .def("rebuild", &AMG::rebuild,
+                "Rebuilds the preconditioner for new matrix values",
+                py::arg("val"));
 
     py::class_<solver>(m, "solver")
         .def(py::init<
@@ -194,10 +285,16 @@ PYBIND11_MODULE(pyamgcl_ext, m) {
                 py::dict
                 >()
             )
-        .def("__call__", (py::array_t<double> (solver::*)(py::array_t<double>) const) &solver::solve)
-        .def("__call__", (py::array_t<double> (solver::*)(
-                        py::array_t<int>, py::array_t<int>, py::array_t<double>, py::array_t<double>) const
-                    ) &solver::solve)
+        .def("__call__", (carray<double> (solver::*)(carray<double>, py::object) const) &solver::solve,
+                py::arg("rhs"), py::arg("x") = py::none())
+        .def("__call__", (carray<double> (solver::*)(
+                        carray<int64_t>, carray<int64_t>, carray<double>, carray<double>, py::object) const
+                    ) &solver::solve<int64_t>,
+                py::arg("ptr"), py::arg("col"), py::arg("val"), py::arg("rhs"), py::arg("x") = py::none())
+        .def("__call__", (carray<double> (solver::*)(
+                        carray<int32_t>, carray<int32_t>, carray<double>, carray<double>, py::object) const
+                    ) &solver::solve<int32_t>,
+                py::arg("ptr"), py::arg("col"), py::arg("val"), py::arg("rhs"), py::arg("x") = py::none())
         .def_property_readonly("iters", &solver::iterations)
         .def_property_readonly("error", &solver::residual)
         ;
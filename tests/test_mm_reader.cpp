@@ -0,0 +1,183 @@
+#define BOOST_TEST_MODULE TestMatrixMarket
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <complex>
+#include <clocale>
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+#include <amgcl/io/mm.hpp>
+
+template <typename Val>
+struct crs {
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<Val>       val;
+};
+
+void write_file(const std::string &fname, const std::string &content) {
+    std::ofstream f(fname.c_str(), std::ios::binary);
+    f << content;
+}
+
+// Reads the matrix with one and several threads, checks that the results
+// are the same, and compares them with the expected CRS arrays.
+template <typename Val>
+void check(const std::string &fname, const crs<Val> &A,
+        size_t nrows, size_t ncols,
+        ptrdiff_t row_beg = -1, ptrdiff_t row_end = -1)
+{
+#ifdef _OPENMP
+    const int nt = omp_get_max_threads();
+    for(int t : {1, 3, 8}) {
+        omp_set_num_threads(t);
+#endif
+        crs<Val> B;
+        size_t n, m;
+
+        std::tie(n, m) = amgcl::io::mm_reader(fname)(B.ptr, B.col, B.val, row_beg, row_end);
+
+        BOOST_CHECK_EQUAL(n, nrows);
+        BOOST_CHECK_EQUAL(m, ncols);
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(B.ptr.begin(), B.ptr.end(), A.ptr.begin(), A.ptr.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(B.col.begin(), B.col.end(), A.col.begin(), A.col.end());
+
+        BOOST_REQUIRE_EQUAL(B.val.size(), A.val.size());
+        for(size_t i = 0; i < A.val.size(); ++i)
+            BOOST_CHECK(B.val[i] == A.val[i]);
+#ifdef _OPENMP
+    }
+    omp_set_num_threads(nt);
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE( test_mm_reader )
+
+BOOST_AUTO_TEST_CASE( general )
+{
+    // Unsorted entries, comments in the body, CRLF line ends, and no
+    // newline at the end of the file.
+    write_file("test_mm_general.mtx",
+            "%%MatrixMarket matrix coordinate real general\n"
+            "% comment\n"
+            "%\n"
+            "4 5 7\n"
+            "1 3 -2.5e-1\n"
+            "1 1 4\r\n"
+            "% comment in the body\n"
+            "  3 5 .125\n"
+            "2 2 1e2\n"
+            "\n"
+            "4 1 -0.001\n"
+            "4 4 12345678901234567890\n"
+            "3 2 +7.5E+3"
+            );
+
+    crs<double> A;
+    A.ptr = {0, 2, 3, 5, 7};
+    A.col = {0, 2, 1, 1, 4, 0, 3};
+    A.val = {4, -0.25, 100, 7500, 0.125, -0.001, 12345678901234567890.0};
+
+    check("test_mm_general.mtx", A, 4, 5);
+
+    // Subset of rows.
+    crs<double> B;
+    B.ptr = {0, 1, 3};
+    B.col = {1, 1, 4};
+    B.val = {100, 7500, 0.125};
+
+    check("test_mm_general.mtx", B, 2, 5, 1, 3);
+}
+
+BOOST_AUTO_TEST_CASE( symmetric )
+{
+    write_file("test_mm_symmetric.mtx",
+            "%%MatrixMarket matrix coordinate real symmetric\n"
+            "3 3 5\n"
+            "1 1 2\n"
+            "2 1 -1\n"
+            "2 2 2\n"
+            "3 2 -1\n"
+            "3 3 2\n"
+            );
+
+    crs<double> A;
+    A.ptr = {0, 2, 5, 7};
+    A.col = {0, 1, 0, 1, 2, 1, 2};
+    A.val = {2, -1, -1, 2, -1, -1, 2};
+
+    check("test_mm_symmetric.mtx", A, 3, 3);
+
+    // The upper triangle entries of the subset come from the lower
+    // triangle rows outside of it.
+    crs<double> B;
+    B.ptr = {0, 2};
+    B.col = {0, 1};
+    B.val = {2, -1};
+
+    check("test_mm_symmetric.mtx", B, 1, 3, 0, 1);
+}
+
+BOOST_AUTO_TEST_CASE( complex_values )
+{
+    write_file("test_mm_complex.mtx",
+            "%%MatrixMarket matrix coordinate complex general\n"
+            "2 2 3\n"
+            "2 1 0.5 -1\n"
+            "1 1 1 2\n"
+            "2 2 -3 0.25\n"
+            );
+
+    crs< std::complex<double> > A;
+    A.ptr = {0, 1, 3};
+    A.col = {0, 0, 1};
+    A.val = {
+        std::complex<double>(1, 2),
+        std::complex<double>(0.5, -1),
+        std::complex<double>(-3, 0.25)
+    };
+
+    check("test_mm_complex.mtx", A, 2, 2);
+}
+
+BOOST_AUTO_TEST_CASE( numeric_locale )
+{
+    // The values should not depend on the decimal separator of the C locale.
+    const char *names[] = {"de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "ru_RU.UTF-8"};
+
+    bool found = false;
+    for(const char *name : names) {
+        if (std::setlocale(LC_NUMERIC, name)) {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        BOOST_TEST_MESSAGE("No locale with a comma decimal separator is available");
+        return;
+    }
+
+    write_file("test_mm_locale.mtx",
+            "%%MatrixMarket matrix coordinate real general\n"
+            "1 2 2\n"
+            "1 1 1.5\n"
+            "1 2 1.234567890123456789e-300\n"
+            );
+
+    crs<double> A;
+    A.ptr = {0, 2};
+    A.col = {0, 1};
+    A.val = {1.5, 1.234567890123456789e-300};
+
+    check("test_mm_locale.mtx", A, 1, 2);
+
+    std::setlocale(LC_NUMERIC, "C");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
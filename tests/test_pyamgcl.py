@@ -42,6 +42,12 @@ def make_problem(n):
 
     return ( csr_matrix( (val, col, ptr) ), rhs )
 
+def index_types(A, ptr_type, col_type):
+    B = A.copy()
+    B.indptr  = B.indptr.astype(ptr_type)
+    B.indices = B.indices.astype(col_type)
+    return B
+
 class TestPyAMGCL(unittest.TestCase):
     def test_solver(self):
         A, rhs = make_problem(100)
@@ -67,5 +73,61 @@ class TestPyAMGCL(unittest.TestCase):
             # Check residual
             self.assertTrue(norm(rhs - A * x) / norm(rhs) < 1e-3)
 
+    def test_inplace(self):
+        A, rhs = make_problem(100)
+
+        for ptr_type, col_type in (
+                (np.int32, np.int32), (np.int64, np.int64), (np.int32, np.int64)):
+            B = index_types(A, ptr_type, col_type)
+
+            P = amg.amgcl(B, prm={'allow_rebuild': True})
+            solve = amg.solver(P, prm=dict(type='cg', tol=1e-6))
+
+            x = np.zeros_like(rhs)
+            y = solve(rhs, x=x)
+            self.assertTrue(y is x)
+            self.assertTrue(norm(rhs - A * x) / norm(rhs) < 1e-6)
+
+            # scipy may narrow the indices of 2 * B, so convert them again.
+            B2 = index_types(2 * A, ptr_type, col_type)
+
+            P.rebuild(B2)
+
+            x[:] = 0
+            y = solve(B2, rhs, x=x)
+            self.assertTrue(y is x)
+            self.assertTrue(norm(rhs - 2 * A * x) / norm(rhs) < 1e-6)
+
+            # The extension gets the index arrays as they are, including
+            # the mixed ones, which are then converted to int64.
+            x[:] = 0
+            y = amg.pyamgcl_ext.solver.__call__(
+                    solve, B2.indptr, B2.indices, B2.data, rhs, x)
+            self.assertTrue(y is x)
+            self.assertTrue(norm(rhs - 2 * A * x) / norm(rhs) < 1e-6)
+
+    def test_output_checks(self):
+        A, rhs = make_problem(20)
+
+        P = amg.amgcl(A)
+        solve = amg.solver(P, prm=dict(type='cg', tol=1e-6))
+
+        # The output array should be a writeable float64 vector of the
+        # right size. It is never silently replaced with a copy.
+        for x in (np.zeros(rhs.size, dtype=np.float32),
+                  np.zeros(rhs.size + 1),
+                  np.zeros(2 * rhs.size)[::2],
+                  np.zeros((rhs.size, 1))):
+            with self.assertRaises(RuntimeError):
+                solve(rhs, x=x)
+
+        x = np.zeros_like(rhs)
+        x.flags.writeable = False
+        with self.assertRaises(RuntimeError):
+            solve(rhs, x=x)
+
+        with self.assertRaises(RuntimeError):
+            P(rhs, x=np.zeros(rhs.size, dtype=np.float32))
+
 if __name__ == "__main__":
     unittest.main()
@@ -133,6 +133,9 @@ void test_problem(
       , amgcl::runtime::relaxation::ilut
 #ifndef AMGCL_RUNTIME_DISABLE_CHEBYSHEV
       , amgcl::runtime::relaxation::chebyshev
+#endif
+#ifndef AMGCL_RUNTIME_DISABLE_MULTICOLOR_GS
+      , amgcl::runtime::relaxation::multicolor_gauss_seidel
 #endif
     };
 
@@ -143,7 +146,9 @@ void test_problem(
         amgcl::runtime::solver::gmres,
         amgcl::runtime::solver::lgmres,
         amgcl::runtime::solver::fgmres,
-        amgcl::runtime::solver::idrs
+        amgcl::runtime::solver::idrs,
+        amgcl::runtime::solver::pipelined_cg,
+        amgcl::runtime::solver::ca_gmres
     };
 
     typename Backend::params prm;
@@ -1,9 +1,85 @@
 #define BOOST_TEST_MODULE TestSolvers
 #include <boost/test/unit_test.hpp>
+#include <map>
 #include <amgcl/backend/builtin.hpp>
+#include <amgcl/adapter/crs_tuple.hpp>
+#include <amgcl/io/binary.hpp>
+#include <amgcl/coarsening/plain_aggregates.hpp>
+#include <amgcl/coarsening/aggregation.hpp>
+#include <amgcl/relaxation/ilu0.hpp>
+#include <amgcl/relaxation/ilut.hpp>
+#include <amgcl/preconditioner/runtime.hpp>
+#include <amgcl/preconditioner/schur_pressure_correction.hpp>
 
 #include "test_solver.hpp"
 
+// Aggregation that keeps the transfer operators made during the first
+// setup, and returns them on the later ones. This allows to set up a new
+// hierarchy with the same transfer operators as a rebuilt one.
+template <class Backend>
+struct fixed_aggregation : public amgcl::coarsening::aggregation<Backend> {
+    typedef amgcl::coarsening::aggregation<Backend> Base;
+    typedef amgcl::backend::crs<typename Backend::value_type> matrix;
+    typedef std::tuple< std::shared_ptr<matrix>, std::shared_ptr<matrix> > transfer;
+
+    static std::vector<transfer> known;
+    size_t level;
+
+    fixed_aggregation(const typename Base::params &prm = typename Base::params())
+        : Base(prm), level(0) {}
+
+    transfer transfer_operators(const matrix &A) {
+        if (level == known.size())
+            known.push_back(Base::transfer_operators(A));
+        return known[level++];
+    }
+};
+
+template <class Backend>
+std::vector<typename fixed_aggregation<Backend>::transfer> fixed_aggregation<Backend>::known;
+
+// SPAI0 smoother that records the size of the OpenMP team it is applied
+// with on each level (by the number of rows of the level).
+template <class Backend>
+struct team_spai0 : public amgcl::relaxation::spai0<Backend> {
+    typedef amgcl::relaxation::spai0<Backend> Base;
+
+    static std::map<size_t, int> teams;
+    size_t n;
+
+    template <class Matrix>
+    team_spai0(const Matrix &A, const typename Base::params &prm,
+            const typename Backend::params &bprm)
+        : Base(A, prm, bprm), n(amgcl::backend::rows(A)) {}
+
+    template <class Matrix, class VectorRHS, class VectorX, class VectorTMP>
+    void apply_pre(const Matrix &A, const VectorRHS &rhs, VectorX &x, VectorTMP &tmp) const {
+        record();
+        Base::apply_pre(A, rhs, x, tmp);
+    }
+
+    template <class Matrix, class VectorRHS, class VectorX, class VectorTMP>
+    void apply_post(const Matrix &A, const VectorRHS &rhs, VectorX &x, VectorTMP &tmp) const {
+        record();
+        Base::apply_post(A, rhs, x, tmp);
+    }
+
+    void record() const {
+        int team = 1;
+#ifdef _OPENMP
+#pragma omp parallel
+        {
+#pragma omp single
+            team = omp_get_num_threads();
+        }
+#endif
+        teams[n] = team;
+    }
+};
+
+template <class Backend>
+std::map<size_t, int> team_spai0<Backend>::teams;
+
 BOOST_AUTO_TEST_SUITE( test_solvers )
 
 BOOST_AUTO_TEST_CASE(test_builtin_backend)
@@ -11,4 +87,775 @@ BOOST_AUTO_TEST_CASE(test_builtin_backend)
     test_backend< amgcl::backend::builtin<double> >();
 }
 
+BOOST_AUTO_TEST_CASE(test_arena)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    boost::property_tree::ptree prm;
+    prm.put("precond.class",         "amg");
+    prm.put("precond.coarse_enough", 500);
+    prm.put("solver.type",           "cg");
+
+    Backend::params bprm;
+    bprm.pool = std::make_shared<amgcl::backend::arena>();
+
+    amgcl::make_solver<
+        amgcl::runtime::preconditioner<Backend>,
+        amgcl::runtime::solver::wrapper<Backend>
+        > solve(std::tie(n, ptr, col, val), prm, bprm);
+
+    BOOST_CHECK(bprm.pool->used_bytes() > 0);
+
+    std::vector<double> x(n, 0.0);
+
+    size_t iters;
+    double resid;
+
+    std::tie(iters, resid) = solve(rhs, x);
+    BOOST_REQUIRE_SMALL(resid, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(test_workspace)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+    typedef amgcl::make_solver<
+        amgcl::runtime::preconditioner<Backend>,
+        amgcl::runtime::solver::wrapper<Backend>
+        > Solver;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    boost::property_tree::ptree prm;
+    prm.put("precond.class",         "amg");
+    prm.put("precond.coarse_enough", 500);
+
+    Backend::params bprm;
+    bprm.scratch = std::make_shared<amgcl::backend::workspace>();
+
+    prm.put("solver.type", "cg");
+    Solver solve1(std::tie(n, ptr, col, val), prm, bprm);
+
+    prm.put("solver.type", "bicgstab");
+    Solver solve2(std::tie(n, ptr, col, val), prm, bprm);
+
+    // Nothing is allocated until the first solve.
+    BOOST_CHECK_EQUAL(bprm.scratch->bytes(), 0u);
+
+    size_t iters;
+    double resid;
+
+    std::vector<double> x(n, 0.0);
+    std::tie(iters, resid) = solve1(rhs, x);
+    BOOST_REQUIRE_SMALL(resid, 1e-4);
+
+    size_t first = bprm.scratch->bytes();
+    BOOST_CHECK(first > 0);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    std::tie(iters, resid) = solve2(rhs, x);
+    BOOST_REQUIRE_SMALL(resid, 1e-4);
+
+    // The second solver reuses the vectors released by the first one.
+    BOOST_CHECK(bprm.scratch->bytes() < 2 * first);
+}
+
+BOOST_AUTO_TEST_CASE(test_numa)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+    typedef amgcl::make_solver<
+        amgcl::runtime::preconditioner<Backend>,
+        amgcl::runtime::solver::wrapper<Backend>
+        > Solver;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    boost::property_tree::ptree prm;
+    prm.put("precond.class",         "amg");
+    prm.put("precond.coarse_enough", 500);
+    prm.put("solver.type",           "bicgstab");
+
+    Backend::params bprm;
+    bprm.numa = std::make_shared<amgcl::backend::numa_layout>();
+
+    Solver solve1(std::tie(n, ptr, col, val), prm);
+    Solver solve2(std::tie(n, ptr, col, val), prm, bprm);
+
+    const auto &part = solve2.system_matrix().part;
+    BOOST_REQUIRE(part);
+    BOOST_CHECK_EQUAL(part->front(), 0);
+    BOOST_CHECK_EQUAL(part->back(), static_cast<ptrdiff_t>(n));
+    BOOST_CHECK(std::is_sorted(part->begin(), part->end()));
+
+    size_t iters1, iters2;
+    double resid1, resid2;
+
+    std::vector<double> x(n, 0.0);
+    std::tie(iters1, resid1) = solve1(rhs, x);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    std::tie(iters2, resid2) = solve2(rhs, x);
+
+    BOOST_REQUIRE_SMALL(resid2, 1e-4);
+    BOOST_CHECK_EQUAL(iters1, iters2);
+
+    // The restriction operator fixes the partition of its row space, which
+    // is then used by the vectors and the system matrix of the coarse level.
+    Backend::params cprm;
+    cprm.numa = std::make_shared<amgcl::backend::numa_layout>();
+
+    auto A = Backend::copy_matrix(
+            std::make_shared<Backend::matrix>(std::tie(n, ptr, col, val)), cprm);
+
+    amgcl::coarsening::aggregation<Backend> C;
+    std::shared_ptr<Backend::matrix> P, R;
+    std::tie(P, R) = C.transfer_operators(*A);
+
+    auto bP = Backend::copy_matrix(P, cprm);
+    auto bR = Backend::copy_matrix(R, cprm);
+    auto Ac = Backend::copy_matrix(C.coarse_operator(*A, *P, *R), cprm);
+    auto fc = Backend::create_vector(amgcl::backend::rows(*R), cprm);
+
+    BOOST_CHECK(bP->part == A->part);
+    BOOST_CHECK(bR->part);
+    BOOST_CHECK(Ac->part == bR->part);
+    BOOST_CHECK(fc->partition() == bR->part);
+}
+
+BOOST_AUTO_TEST_CASE(test_serial_coarse)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+    typedef amgcl::make_solver<
+        amgcl::amg<Backend, amgcl::coarsening::smoothed_aggregation, team_spai0>,
+        amgcl::solver::cg<Backend>
+        > Solver;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    const size_t serial_size = 5000;
+
+    Solver::params prm;
+    prm.precond.coarse_enough      = 500;
+    prm.precond.serial_coarse_size = serial_size;
+
+#ifdef _OPENMP
+    // Make sure the team has more than one thread outside of the serial
+    // region.
+    const int nt = omp_get_max_threads();
+    omp_set_num_threads(4);
+#endif
+
+    Solver solve(std::tie(n, ptr, col, val), prm);
+
+    team_spai0<Backend>::teams.clear();
+
+    std::vector<double> x(n, 0.0);
+
+    size_t iters;
+    double resid;
+
+    std::tie(iters, resid) = solve(rhs, x);
+    BOOST_REQUIRE_SMALL(resid, 1e-4);
+
+    // The levels below serial_coarse_size run with a single thread, and the
+    // ones above it with the full team.
+    size_t serial = 0, parallel = 0;
+    for(const auto &t : team_spai0<Backend>::teams) {
+        if (t.first < serial_size) {
+            ++serial;
+            BOOST_CHECK_EQUAL(t.second, 1);
+        } else {
+            ++parallel;
+#ifdef _OPENMP
+            BOOST_CHECK_EQUAL(t.second, 4);
+#endif
+        }
+    }
+
+    BOOST_CHECK(serial > 0);
+    BOOST_CHECK(parallel > 0);
+
+#ifdef _OPENMP
+    // The number of threads is restored after the cycle.
+    BOOST_CHECK_EQUAL(omp_get_max_threads(), 4);
+    omp_set_num_threads(nt);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_residual_restrict)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    auto A = std::make_shared<Backend::matrix>(std::tie(n, ptr, col, val));
+
+    amgcl::coarsening::aggregation<Backend> C;
+    std::shared_ptr<Backend::matrix> P, R;
+    std::tie(P, R) = C.transfer_operators(*A);
+    amgcl::backend::sort_rows(*R);
+
+    const size_t nc = amgcl::backend::rows(*R);
+
+    for(int numa = 0; numa < 2; ++numa) {
+        Backend::params bprm;
+        if (numa) bprm.numa = std::make_shared<amgcl::backend::numa_layout>();
+
+#ifdef _OPENMP
+        // The plan is made for four blocks, and is used by teams of
+        // different sizes.
+        const int nt = omp_get_max_threads();
+        omp_set_num_threads(4);
+#endif
+
+        auto bA = Backend::copy_matrix(A, bprm);
+        auto bR = Backend::copy_matrix(R, bprm);
+
+        auto plan = amgcl::backend::restriction_plan<Backend>::create(*bA, *bR, bprm);
+        BOOST_REQUIRE(plan);
+
+        auto f = Backend::copy_vector(rhs, bprm);
+        auto x = Backend::create_vector(n, bprm);
+        auto t = Backend::create_vector(n, bprm);
+
+        for(size_t i = 0; i < n; ++i) (*x)[i] = std::sin(0.1 * i);
+
+        std::vector<double> r(n), fc(nc);
+        amgcl::backend::residual(rhs, *A, *x, r);
+        amgcl::backend::spmv(1.0, *R, r, 0.0, fc);
+
+        for(int team : {1, 3, 4}) {
+#ifdef _OPENMP
+            omp_set_num_threads(team);
+#endif
+            auto c = Backend::create_vector(nc, bprm);
+            amgcl::backend::residual_restrict(*f, *bA, *x, *bR, plan.get(), *t, *c);
+
+            for(size_t i = 0; i < nc; ++i)
+                BOOST_CHECK_SMALL((*c)[i] - fc[i], 1e-12);
+        }
+
+#ifdef _OPENMP
+        omp_set_num_threads(nt);
+#endif
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_aggregates)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    amgcl::backend::crs<double> A(std::tie(n, ptr, col, val));
+
+    amgcl::coarsening::plain_aggregates::params aprm;
+    aprm.parallel = true;
+
+    amgcl::coarsening::plain_aggregates aggr(A, aprm);
+
+    // Every connected node belongs to an existing aggregate, and no
+    // aggregate is empty.
+    std::vector<int> size(aggr.count, 0);
+    for(size_t i = 0; i < n; ++i) {
+        BOOST_REQUIRE(aggr.id[i] >= 0);
+        BOOST_REQUIRE(aggr.id[i] < static_cast<ptrdiff_t>(aggr.count));
+        ++size[aggr.id[i]];
+    }
+    for(int s : size) BOOST_CHECK(s > 0);
+
+    // The convergence is comparable to the one with sequential aggregation.
+    size_t iters[2];
+    for(int p = 0; p < 2; ++p) {
+        boost::property_tree::ptree prm;
+        prm.put("precond.class",                "amg");
+        prm.put("precond.coarsening.type",      "smoothed_aggregation");
+        prm.put("precond.coarsening.aggr.parallel", p);
+        prm.put("solver.type",                  "cg");
+
+        amgcl::make_solver<
+            amgcl::runtime::preconditioner<Backend>,
+            amgcl::runtime::solver::wrapper<Backend>
+            > solve(std::tie(n, ptr, col, val), prm);
+
+        std::vector<double> x(n, 0.0);
+        double resid;
+
+        std::tie(iters[p], resid) = solve(rhs, x);
+        BOOST_REQUIRE_SMALL(resid, 1e-4);
+    }
+
+    BOOST_CHECK_LE(iters[1], iters[0] + 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_ruge_stuben_parallel)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    for(const char *split : {"classic", "pmis", "hmis"}) {
+        for(const char *interp : {"direct", "extended_i"}) {
+            boost::property_tree::ptree prm;
+            prm.put("precond.class",                 "amg");
+            prm.put("precond.coarsening.type",       "ruge_stuben");
+            prm.put("precond.coarsening.split",      split);
+            prm.put("precond.coarsening.interp",     interp);
+            prm.put("solver.type",                   "cg");
+
+            amgcl::make_solver<
+                amgcl::runtime::preconditioner<Backend>,
+                amgcl::runtime::solver::wrapper<Backend>
+                > solve(std::tie(n, ptr, col, val), prm);
+
+            std::vector<double> x(n, 0.0);
+
+            size_t iters;
+            double resid;
+
+            std::tie(iters, resid) = solve(rhs, x);
+
+            BOOST_TEST_MESSAGE(split << "/" << interp << ": " << iters);
+            BOOST_REQUIRE_SMALL(resid, 1e-4);
+            BOOST_CHECK_LE(iters, 30u);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parilu)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+    typedef amgcl::relaxation::ilu0<Backend> ILU;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(8, val, col, ptr, rhs, 0.5);
+
+    Backend::matrix A(std::tie(n, ptr, col, val));
+
+    std::vector<double> f(n), x0(n), x1(n);
+    for(size_t i = 0; i < n; ++i) f[i] = sin(static_cast<double>(i));
+
+    ILU::params prm;
+    prm.solve.serial = true;
+
+    ILU(A, prm, Backend::params()).apply(A, f, x0);
+
+    // The fixed-point iteration converges to the exact ILU(0) factors.
+    prm.factor_sweeps = 50;
+    ILU(A, prm, Backend::params()).apply(A, f, x1);
+
+    for(size_t i = 0; i < n; ++i)
+        BOOST_CHECK_SMALL(x1[i] - x0[i], 1e-10);
+
+    // A few sweeps make a good enough smoother.
+    boost::property_tree::ptree p;
+    p.put("precond.class",                "amg");
+    p.put("precond.relax.type",           "ilu0");
+    p.put("precond.relax.factor_sweeps",  3);
+    p.put("solver.type",                  "bicgstab");
+
+    amgcl::make_solver<
+        amgcl::runtime::preconditioner<Backend>,
+        amgcl::runtime::solver::wrapper<Backend>
+        > solve(std::tie(n, ptr, col, val), p);
+
+    std::vector<double> x(n, 0.0);
+
+    size_t iters;
+    double resid;
+
+    std::tie(iters, resid) = solve(rhs, x);
+    BOOST_REQUIRE_SMALL(resid, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(test_schur_pressure_correction)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(16, val, col, ptr, rhs);
+
+    std::vector<char>      pmask(n);
+    std::vector<ptrdiff_t> uidx, pidx;
+    for(size_t i = 0; i < n; ++i) {
+        pmask[i] = (i % 4 == 0);
+        (pmask[i] ? pidx : uidx).push_back(i);
+    }
+
+    // Index gather/scatter should match the permutation matrices.
+    amgcl::preconditioner::detail::schur_transfer<Backend>
+        T1(n, uidx, pidx, Backend::params());
+    amgcl::preconditioner::detail::schur_transfer<Backend, int>
+        T2(n, uidx, pidx, Backend::params());
+
+    amgcl::backend::numa_vector<double> x(n), y1(n), y2(n);
+    amgcl::backend::numa_vector<double> u1(uidx.size()), u2(uidx.size());
+    amgcl::backend::numa_vector<double> p1(pidx.size()), p2(pidx.size());
+
+    for(size_t i = 0; i < n; ++i) {
+        x[i]  = sin(static_cast<double>(i));
+        y1[i] = y2[i] = 42;
+    }
+
+    T1.gather(x, u1, p1);
+    T2.gather(x, u2, p2);
+
+    for(size_t i = 0; i < uidx.size(); ++i) BOOST_CHECK_EQUAL(u1[i], u2[i]);
+    for(size_t i = 0; i < pidx.size(); ++i) BOOST_CHECK_EQUAL(p1[i], p2[i]);
+
+    // The output is not cleared before the scatter.
+    T1.scatter(u1, p1, y1);
+    T2.scatter(u2, p2, y2);
+
+    for(size_t i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(y1[i], x[i]);
+        BOOST_CHECK_EQUAL(y2[i], x[i]);
+    }
+
+    typedef amgcl::make_solver<
+        amgcl::amg<Backend, amgcl::runtime::coarsening::wrapper, amgcl::runtime::relaxation::wrapper>,
+        amgcl::runtime::solver::wrapper<Backend>
+        > USolver;
+
+    typedef amgcl::make_solver<
+        amgcl::relaxation::as_preconditioner<Backend, amgcl::runtime::relaxation::wrapper>,
+        amgcl::runtime::solver::wrapper<Backend>
+        > PSolver;
+
+    typedef amgcl::make_solver<
+        amgcl::preconditioner::schur_pressure_correction<USolver, PSolver>,
+        amgcl::runtime::solver::wrapper<Backend>
+        > Solver;
+
+    Solver::params prm;
+    prm.precond.pmask = pmask;
+    prm.precond.usolver.solver.put("tol", 1e-2);
+    prm.precond.psolver.solver.put("tol", 1e-2);
+    prm.solver.put("type", "gmres");
+
+    for(int type = 1; type <= 2; ++type) {
+        prm.precond.type = type;
+        Solver solve(std::tie(n, ptr, col, val), prm);
+
+        std::vector<double> x(n, 0.0);
+
+        size_t iters;
+        double resid;
+
+        std::tie(iters, resid) = solve(rhs, x);
+        BOOST_CHECK_SMALL(resid, 1e-8);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_mixed_precision)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    boost::property_tree::ptree prm;
+    prm.put("precond.class",                 "amg");
+    prm.put("precond.coarse_enough",         500);
+    prm.put("precond.full_precision_levels", 1);
+    prm.put("solver.type",                   "cg");
+
+    amgcl::make_solver<
+        amgcl::runtime::preconditioner<Backend>,
+        amgcl::runtime::solver::wrapper<Backend>
+        > solve(std::tie(n, ptr, col, val), prm);
+
+    std::vector<double> x(n, 0.0);
+
+    size_t iters;
+    double resid;
+
+    std::tie(iters, resid) = solve(rhs, x);
+    BOOST_REQUIRE_SMALL(resid, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(test_lower_precision_relax_params)
+{
+    // The lower precision levels get a copy of the relaxation parameters
+    // that does not depend on the property tree conversion.
+    typedef amgcl::relaxation::ilut< amgcl::backend::builtin<double> > Relax;
+    typedef amgcl::relaxation::ilut< amgcl::backend::builtin<float>  > LPRelax;
+
+    Relax::params prm;
+    prm.p            = 3;
+    prm.tau          = 0.25;
+    prm.damping      = 0.5;
+    prm.solve.serial = !prm.solve.serial;
+
+    LPRelax::params lp(prm);
+
+    BOOST_CHECK_EQUAL(lp.p,            prm.p);
+    BOOST_CHECK_EQUAL(lp.tau,          0.25f);
+    BOOST_CHECK_EQUAL(lp.damping,      0.5f);
+    BOOST_CHECK_EQUAL(lp.solve.serial, prm.solve.serial);
+}
+
+BOOST_AUTO_TEST_CASE(test_save_hierarchy)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+    typedef amgcl::make_solver<
+        amgcl::amg<
+            Backend,
+            amgcl::runtime::coarsening::wrapper,
+            amgcl::runtime::relaxation::wrapper
+            >,
+        amgcl::runtime::solver::wrapper<Backend>
+        > Solver;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    boost::property_tree::ptree prm;
+    prm.put("precond.coarse_enough",         500);
+    prm.put("precond.full_precision_levels", 2);
+    prm.put("solver.type",                   "cg");
+
+    const std::string fname = "test_hierarchy.bin";
+
+    size_t iters1, iters2;
+    double resid1, resid2;
+
+    std::vector<double> x1(n, 0.0), x2(n, 0.0);
+
+    {
+        Solver solve(std::tie(n, ptr, col, val), prm);
+        solve.precond().save(fname);
+        std::tie(iters1, resid1) = solve(rhs, x1);
+    }
+
+    {
+        Solver solve(amgcl::io::hierarchy(fname), prm);
+        BOOST_CHECK_EQUAL(solve.size(), n);
+        std::tie(iters2, resid2) = solve(rhs, x2);
+    }
+
+    std::remove(fname.c_str());
+
+    BOOST_REQUIRE_SMALL(resid2, 1e-4);
+    BOOST_CHECK_EQUAL(iters1, iters2);
+
+    for(size_t i = 0; i < n; ++i)
+        BOOST_CHECK_CLOSE(x1[i], x2[i], 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(test_map_crs)
+{
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(16, val, col, ptr, rhs);
+
+    // Store one of the rows unsorted.
+    std::reverse(col.begin() + ptr[1], col.begin() + ptr[2]);
+    std::reverse(val.begin() + ptr[1], val.begin() + ptr[2]);
+
+    const std::string fname = "test_map_crs.bin";
+    {
+        std::ofstream f(fname, std::ios::binary);
+        amgcl::io::write(f, n);
+        amgcl::io::write(f, ptr);
+        amgcl::io::write(f, col);
+        amgcl::io::write(f, val);
+    }
+
+    std::vector<ptrdiff_t> ptr2, col2;
+    std::vector<double>    val2;
+    size_t n2;
+
+    amgcl::io::read_crs(fname, n2, ptr2, col2, val2);
+
+    {
+        auto A = amgcl::io::map_crs<double>(fname);
+
+        BOOST_REQUIRE_EQUAL(A->nrows, n);
+        BOOST_REQUIRE_EQUAL(A->nnz, col2.size());
+
+        for(size_t i = 0; i <= n; ++i)
+            BOOST_CHECK_EQUAL(A->ptr[i], ptr2[i]);
+
+        for(size_t j = 0; j < A->nnz; ++j) {
+            BOOST_CHECK_EQUAL(A->col[j], col2[j]);
+            BOOST_CHECK_EQUAL(A->val[j], val2[j]);
+        }
+    }
+
+    std::remove(fname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_rebuild)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+    typedef amgcl::make_solver<
+        amgcl::amg<Backend, fixed_aggregation, amgcl::relaxation::spai0>,
+        amgcl::solver::cg<Backend>
+        > Solver;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    Solver::params prm;
+    prm.precond.coarse_enough = 500;
+    prm.precond.allow_rebuild = true;
+
+    fixed_aggregation<Backend>::known.clear();
+
+    Solver solve(std::tie(n, ptr, col, val), prm);
+
+    std::vector<double> x(n, 0.0);
+
+    size_t iters;
+    double resid;
+
+    std::tie(iters, resid) = solve(rhs, x);
+    BOOST_REQUIRE_SMALL(resid, 1e-4);
+
+    // Change matrix values, keep the sparsity pattern.
+    for(size_t i = 0; i < n; ++i) {
+        for(ptrdiff_t j = ptr[i]; j < ptr[i+1]; ++j) {
+            if (col[j] == static_cast<ptrdiff_t>(i)) val[j] *= 1.5;
+            else val[j] *= 0.75;
+        }
+    }
+
+    solve.rebuild(std::tie(n, ptr, col, val));
+
+    // The solver uses the system matrix of the rebuilt hierarchy.
+    std::fill(x.begin(), x.end(), 0.0);
+    std::tie(iters, resid) = solve(rhs, x);
+
+    std::cout << "Rebuild: " << iters << " " << resid << std::endl;
+
+    BOOST_REQUIRE_SMALL(resid, 1e-4);
+
+    Backend::matrix A(std::tie(n, ptr, col, val));
+    std::vector<double> r(n);
+    amgcl::backend::residual(rhs, A, x, r);
+    BOOST_REQUIRE_SMALL(
+            sqrt(amgcl::backend::inner_product(r, r) /
+                 amgcl::backend::inner_product(rhs, rhs)), 1e-4);
+
+    // A new setup with the same transfer operators should give the same
+    // hierarchy, and so the same solution.
+    BOOST_REQUIRE(!fixed_aggregation<Backend>::known.empty());
+
+    Solver fresh(std::tie(n, ptr, col, val), prm);
+
+    std::vector<double> y(n, 0.0);
+    size_t iters2;
+    double resid2;
+    std::tie(iters2, resid2) = fresh(rhs, y);
+
+    BOOST_CHECK_EQUAL(iters, iters2);
+    BOOST_CHECK_EQUAL(resid, resid2);
+
+    for(size_t i = 0; i < n; ++i)
+        BOOST_CHECK_EQUAL(x[i], y[i]);
+}
+
+BOOST_AUTO_TEST_CASE(test_product_plan)
+{
+    typedef amgcl::backend::builtin<double> Backend;
+    typedef Backend::matrix matrix;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(16, val, col, ptr, rhs);
+
+    auto A = std::make_shared<matrix>(std::tie(n, ptr, col, val));
+
+    amgcl::coarsening::aggregation<Backend> C;
+    std::shared_ptr<matrix> P, R;
+    std::tie(P, R) = C.transfer_operators(*A);
+    amgcl::backend::sort_rows(*P);
+    amgcl::backend::sort_rows(*R);
+
+    auto check_equal = [](const matrix &X, const matrix &Y) {
+        BOOST_REQUIRE_EQUAL(X.nrows, Y.nrows);
+        BOOST_REQUIRE_EQUAL(X.ncols, Y.ncols);
+        BOOST_REQUIRE_EQUAL(X.nnz,   Y.nnz);
+
+        for(size_t i = 0; i <= X.nrows; ++i)
+            BOOST_CHECK_EQUAL(X.ptr[i], Y.ptr[i]);
+
+        for(size_t j = 0; j < X.nnz; ++j) {
+            BOOST_CHECK_EQUAL(X.col[j], Y.col[j]);
+            BOOST_CHECK_EQUAL(X.val[j], Y.val[j]);
+        }
+    };
+
+#ifdef _OPENMP
+    // The numeric pass sums the products in the same order as the saad
+    // method, which is used with up to 16 threads.
+    const int nt = omp_get_max_threads();
+    omp_set_num_threads(std::min(nt, 16));
+#endif
+
+    amgcl::backend::product_plan<ptrdiff_t> AP_plan, RAP_plan;
+
+    // The first call fills the plan.
+    amgcl::backend::product(*A, *P, AP_plan);
+    amgcl::backend::product(*R, *A, *P, RAP_plan);
+
+    // The later ones only compute the values of the product.
+    for(size_t i = 0; i < A->nnz; ++i) A->val[i] *= 1 + 0.01 * (i % 5);
+
+    check_equal(
+            *amgcl::backend::product(*A, *P, AP_plan),
+            *amgcl::backend::product(*A, *P, /*sort*/true)
+            );
+
+    check_equal(
+            *amgcl::backend::product(*R, *A, *P, RAP_plan),
+            *amgcl::backend::product(*R, *A, *P, /*sort*/true)
+            );
+
+    // The square of A has a wider sparsity pattern, which is detected.
+    auto A2 = amgcl::backend::product(*A, *A, /*sort*/true);
+
+    BOOST_CHECK_THROW(amgcl::backend::product(*A2, *P, AP_plan), std::runtime_error);
+    BOOST_CHECK_THROW(amgcl::backend::product(*R, *A2, *P, RAP_plan), std::runtime_error);
+
+#ifdef _OPENMP
+    omp_set_num_threads(nt);
+#endif
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+#define BOOST_TEST_MODULE TestSolvers
+#include <boost/test/unit_test.hpp>
+#include <amgcl/backend/builtin_dcrs.hpp>
+
+#include "test_solver.hpp"
+
+// Random access iterator over a short periodic sequence. Allows to multiply
+// a matrix with a huge number of columns without allocating the vector.
+class periodic_iterator {
+    public:
+        typedef double                          value_type;
+        typedef ptrdiff_t                       difference_type;
+        typedef const double*                   pointer;
+        typedef const double&                   reference;
+        typedef std::random_access_iterator_tag iterator_category;
+
+        periodic_iterator(const std::vector<double> &v, ptrdiff_t pos = 0)
+            : v(&v), pos(pos) {}
+
+        const double& operator[](ptrdiff_t i) const {
+            return (*v)[(pos + i) % v->size()];
+        }
+
+        periodic_iterator operator+(ptrdiff_t i) const {
+            return periodic_iterator(*v, pos + i);
+        }
+
+        ptrdiff_t operator-(const periodic_iterator &other) const {
+            return pos - other.pos;
+        }
+    private:
+        const std::vector<double> *v;
+        ptrdiff_t pos;
+};
+
+// Checks spmv and residual with the delta-compressed matrix against the
+// CRS one.
+template <class Vector>
+void check_kernels(std::shared_ptr< amgcl::backend::crs<double> > A, const Vector &x)
+{
+    typedef amgcl::backend::builtin_dcrs<double> Backend;
+
+    auto B = Backend::copy_matrix(A, Backend::params());
+
+    const size_t n = A->nrows;
+
+    std::vector<double> f(n), y1(n), y2(n);
+    for(size_t i = 0; i < n; ++i) f[i] = y1[i] = y2[i] = 1.0 / (1 + i % 7);
+
+    amgcl::backend::spmv(2.0, *A, x, 0.5, y1);
+    amgcl::backend::spmv(2.0, *B, x, 0.5, y2);
+
+    for(size_t i = 0; i < n; ++i)
+        BOOST_CHECK_EQUAL(y1[i], y2[i]);
+
+    amgcl::backend::spmv(1.0, *A, x, 0.0, y1);
+    amgcl::backend::spmv(1.0, *B, x, 0.0, y2);
+
+    for(size_t i = 0; i < n; ++i)
+        BOOST_CHECK_EQUAL(y1[i], y2[i]);
+
+    amgcl::backend::residual(f, *A, x, y1);
+    amgcl::backend::residual(f, *B, x, y2);
+
+    for(size_t i = 0; i < n; ++i)
+        BOOST_CHECK_EQUAL(y1[i], y2[i]);
+}
+
+// One-dimensional Poisson matrix, with the first and the last unknowns
+// coupled (the periodic boundary conditions).
+std::shared_ptr< amgcl::backend::crs<double> > periodic_poisson(ptrdiff_t n) {
+    auto A = std::make_shared< amgcl::backend::crs<double> >();
+    A->set_size(n, n);
+    A->ptr[0] = 0;
+
+    for(ptrdiff_t i = 0; i < n; ++i)
+        A->ptr[i+1] = A->ptr[i] + 3;
+
+    A->set_nonzeros();
+
+    for(ptrdiff_t i = 0, j = 0; i < n; ++i, j += 3) {
+        A->col[j  ] = (i + n - 1) % n;
+        A->col[j+1] = i;
+        A->col[j+2] = (i + 1) % n;
+
+        A->val[j  ] = -1;
+        A->val[j+1] =  2 + 1e-3 * i;
+        A->val[j+2] = -1;
+    }
+
+    return A;
+}
+
+BOOST_AUTO_TEST_SUITE( test_solvers )
+
+BOOST_AUTO_TEST_CASE(test_builtin_dcrs_backend)
+{
+    test_backend< amgcl::backend::builtin_dcrs<double> >();
+}
+
+BOOST_AUTO_TEST_CASE(test_dcrs_narrow)
+{
+    const ptrdiff_t n = 1000;
+    auto A = periodic_poisson(n);
+
+    amgcl::backend::dcrs<double> B(A);
+    BOOST_CHECK(B.is_compressed());
+    BOOST_CHECK(B.is_narrow());
+
+    std::vector<double> x(n);
+    for(ptrdiff_t i = 0; i < n; ++i) x[i] = std::sin(0.1 * i);
+
+    check_kernels(A, x);
+}
+
+BOOST_AUTO_TEST_CASE(test_dcrs_wide)
+{
+    // The first and the last rows span more than 2^16 columns.
+    const ptrdiff_t n = 70000;
+    auto A = periodic_poisson(n);
+
+    amgcl::backend::dcrs<double> B(A);
+    BOOST_CHECK(B.is_compressed());
+    BOOST_CHECK(!B.is_narrow());
+    BOOST_CHECK_EQUAL(B.d32.size(), A->nnz);
+
+    std::vector<double> x(n);
+    for(ptrdiff_t i = 0; i < n; ++i) x[i] = std::sin(0.1 * i);
+
+    check_kernels(A, x);
+}
+
+BOOST_AUTO_TEST_CASE(test_dcrs_crs_fallback)
+{
+    // A short matrix with rows that span more than 2^32 columns.
+    const ptrdiff_t n = 16;
+    const ptrdiff_t m = (static_cast<ptrdiff_t>(1) << 32) + 1000;
+
+    auto A = std::make_shared< amgcl::backend::crs<double> >();
+    A->set_size(n, m);
+    A->ptr[0] = 0;
+
+    for(ptrdiff_t i = 0; i < n; ++i)
+        A->ptr[i+1] = A->ptr[i] + 2;
+
+    A->set_nonzeros();
+
+    for(ptrdiff_t i = 0, j = 0; i < n; ++i, j += 2) {
+        A->col[j  ] = i;
+        A->col[j+1] = m - 1 - i;
+
+        A->val[j  ] = 1 + i;
+        A->val[j+1] = -0.5;
+    }
+
+    amgcl::backend::dcrs<double> B(A);
+    BOOST_CHECK(!B.is_compressed());
+
+    std::vector<double> v(101);
+    for(size_t i = 0; i < v.size(); ++i) v[i] = std::sin(0.1 * i);
+
+    amgcl::iterator_range<periodic_iterator> x(
+            periodic_iterator(v), periodic_iterator(v, m));
+
+    check_kernels(A, x);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
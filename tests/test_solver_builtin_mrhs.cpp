@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE TestSolvers
+#include <boost/test/unit_test.hpp>
+#include <amgcl/backend/builtin_mrhs.hpp>
+#include <amgcl/adapter/crs_tuple.hpp>
+#include <amgcl/solver/cg.hpp>
+#include <amgcl/solver/bicgstab.hpp>
+#include <amgcl/solver/pipelined_cg.hpp>
+
+#include "test_solver.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_solvers )
+
+template <template <class, class> class Solver>
+void test_mrhs(const std::string &relaxation)
+{
+    const int K = 4;
+
+    typedef amgcl::backend::builtin_mrhs<double, K> MBackend;
+    typedef amgcl::multi_rhs<double, K>             rhs_type;
+
+    std::vector<ptrdiff_t> ptr, col;
+    std::vector<double>    val, rhs;
+
+    size_t n = sample_problem(32, val, col, ptr, rhs);
+
+    // The right-hand sides differ by several orders of magnitude, and each
+    // of the systems has to converge relative to its own one. The initial
+    // approximation is the same for all of the systems, so that the initial
+    // relative residuals differ as well.
+    const double scale[K] = {1, 1e-6, 1e4, 1e-3};
+
+    std::vector<rhs_type> F(n), X(n);
+    for(size_t i = 0; i < n; ++i)
+        for(int k = 0; k < K; ++k) {
+            F[i](k) = scale[k] * (rhs[i] + sin(0.1 * i * k));
+            X[i](k) = cos(0.01 * i);
+        }
+
+    boost::property_tree::ptree prm;
+    prm.put("precond.coarse_enough", 500);
+    prm.put("precond.relax.type",    relaxation);
+
+    amgcl::make_solver<
+        amgcl::amg<MBackend, amgcl::runtime::coarsening::wrapper, amgcl::runtime::relaxation::wrapper>,
+        Solver<MBackend, amgcl::solver::detail::default_inner_product>
+        > solve(std::tie(n, ptr, col, val), prm);
+
+    size_t iters;
+    double resid;
+
+    std::tie(iters, resid) = solve(F, X);
+
+    std::cout << "Multi-RHS: " << iters << " " << resid << std::endl;
+    BOOST_REQUIRE_SMALL(resid, 1e-8);
+
+    // Each of the solutions should satisfy its own system.
+    amgcl::backend::crs<double> A(std::tie(n, ptr, col, val));
+
+    for(int k = 0; k < K; ++k) {
+        std::vector<double> f(n), x(n), r(n);
+        for(size_t i = 0; i < n; ++i) {
+            f[i] = F[i](k);
+            x[i] = X[i](k);
+        }
+
+        amgcl::backend::residual(f, A, x, r);
+
+        BOOST_CHECK_SMALL(
+                sqrt(amgcl::backend::inner_product(r, r) / amgcl::backend::inner_product(f, f)),
+                1e-7);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_mrhs_cg)
+{
+    test_mrhs<amgcl::solver::cg>("spai0");
+    test_mrhs<amgcl::solver::cg>("gauss_seidel");
+}
+
+BOOST_AUTO_TEST_CASE(test_mrhs_pipelined_cg)
+{
+    test_mrhs<amgcl::solver::pipelined_cg>("spai0");
+}
+
+BOOST_AUTO_TEST_CASE(test_mrhs_bicgstab)
+{
+    test_mrhs<amgcl::solver::bicgstab>("spai0");
+    test_mrhs<amgcl::solver::bicgstab>("ilu0");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
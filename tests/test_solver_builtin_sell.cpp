@@ -0,0 +1,14 @@
+#define BOOST_TEST_MODULE TestSolvers
+#include <boost/test/unit_test.hpp>
+#include <amgcl/backend/builtin_sell.hpp>
+
+#include "test_solver.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_solvers )
+
+BOOST_AUTO_TEST_CASE(test_builtin_sell_backend)
+{
+    test_backend< amgcl::backend::builtin_sell<double> >();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
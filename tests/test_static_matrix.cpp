@@ -34,6 +34,30 @@ BOOST_AUTO_TEST_CASE( product ) {
     BOOST_CHECK_EQUAL(c(1,1), 5);
 }
 
+template <int N>
+void check_mul_add() {
+    amgcl::static_matrix<double, N, N> a;
+    amgcl::static_matrix<double, N, 1> x, y, z;
+
+    for(int i = 0; i < N * N; ++i) a(i) = i + 1;
+    for(int i = 0; i < N; ++i) {
+        x(i) = 2 * i - 1;
+        y(i) = z(i) = 3 - i;
+    }
+
+    z += a * x;
+    amgcl::math::mul_add(a, x, y);
+
+    for(int i = 0; i < N; ++i)
+        BOOST_CHECK_EQUAL(y(i), z(i));
+}
+
+BOOST_AUTO_TEST_CASE( mul_add ) {
+    check_mul_add<2>();
+    check_mul_add<3>();
+    check_mul_add<4>();
+}
+
 BOOST_AUTO_TEST_CASE( scale ) {
     amgcl::static_matrix<int, 2, 2> a = {{1, 2, 3, 4}};
     amgcl::static_matrix<int, 2, 2> c = 2 * a;